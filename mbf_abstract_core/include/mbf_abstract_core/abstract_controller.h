@@ -110,6 +110,30 @@ namespace mbf_abstract_core{
        */
       virtual bool setPlan(const std::vector<geometry_msgs::PoseStamped> &plan) = 0;
 
+      /**
+       * @brief Whether the controller can prepare a new plan concurrently with computeVelocityCommands calls
+       * (see preparePlan and commitPreparedPlan). Controllers with costly plan preprocessing (e.g. pruning,
+       * smoothing or spline fitting) should support it, so replanning doesn't make them miss the cycle deadline.
+       * @return True if preparePlan and commitPreparedPlan are implemented; false by default
+       */
+      virtual bool supportsPlanPreparation() { return false; }
+
+      /**
+       * @brief Preprocesses a new plan, without affecting the one being followed. It's called from a different
+       * thread than computeVelocityCommands, and concurrently with it. Only called if supportsPlanPreparation
+       * returns true.
+       * @param plan The plan to prepare
+       * @return True if the plan was successfully prepared, false if it is invalid
+       */
+      virtual bool preparePlan(const std::vector<geometry_msgs::PoseStamped> &plan) { return false; }
+
+      /**
+       * @brief Replaces the plan being followed with the one prepared by the last preparePlan call. It's called
+       * between two computeVelocityCommands calls, so it should be cheap.
+       * @return True if the prepared plan is now followed, false otherwise
+       */
+      virtual bool commitPreparedPlan() { return false; }
+
       /**
        * @brief Requests the planner to cancel, e.g. if it takes too much time.
        * @return True if a cancel has been successfully requested, false if not implemented.
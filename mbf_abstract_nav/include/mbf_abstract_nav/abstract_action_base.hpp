@@ -45,9 +45,9 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/bind.hpp>
 
+#include <array>
 #include <string>
-#include <map>
-#include <utility>
+#include <vector>
 
 #include <actionlib/server/action_server.h>
 #include <mbf_utility/robot_information.h>
@@ -76,19 +76,24 @@ class AbstractActionBase
   typedef boost::shared_ptr<AbstractActionBase> Ptr;
   typedef typename actionlib::ActionServer<Action>::GoalHandle GoalHandle;
 
-  /// @brief POD holding info for one execution
-  struct ConcurrencySlot{
-    ConcurrencySlot() : thread_ptr(NULL), in_use(false){}
+  /// @brief Info for one execution; aligned to cache lines, so independent slots never share one
+  struct alignas(64) ConcurrencySlot{
+    ConcurrencySlot() : thread_ptr(NULL), in_use(false), has_pending(false){}
     typename Execution::Ptr execution;
     boost::thread* thread_ptr; ///< Owned pointer to a thread
     GoalHandle goal_handle;
     bool in_use;
+    typename Execution::Ptr pending_execution; ///< Execution queued while the current one is being canceled
+    GoalHandle pending_goal_handle; ///< Goal queued while the current one is being canceled
+    bool has_pending; ///< True if there's a queued goal, that the slot thread will run next
+    boost::mutex mtx; ///< Guards all the fields above
   };
 
 protected:
   // not part of the public interface
-  // todo change to unordered_map
-  typedef std::map<uint8_t, ConcurrencySlot> ConcurrencyMap;
+  // one entry per possible concurrency slot id, so lookups are plain indexing and need no global lock
+  typedef std::array<ConcurrencySlot, 256> ConcurrencySlots;
+  typedef typename actionlib::ActionServer<Action>::Result Result;
 public:
 
   /**
@@ -108,19 +113,35 @@ public:
   virtual ~AbstractActionBase()
   {
     // cleanup threads used on executions
-    // note: cannot call cancelAll, since our mutex is not recursive
-    boost::lock_guard<boost::mutex> guard(slot_map_mtx_);
-    typename ConcurrencyMap::iterator slot_it = concurrency_slots_.begin();
-    for (; slot_it != concurrency_slots_.end(); ++slot_it)
+    // note: we cannot join while holding the slot mutexes, as the slot threads lock them when they finish
+    std::vector<typename Execution::Ptr> executions;
+    std::vector<GoalHandle> pending_goals;
+    for (size_t i = 0; i < concurrency_slots_.size(); ++i)
     {
-      // cancel and join all spawned threads.
-      slot_it->second.execution->cancel();
-      if(slot_it->second.thread_ptr->joinable())
-        slot_it->second.thread_ptr->join();
-
-      // unregister and delete
-      threads_.remove_thread(slot_it->second.thread_ptr);
-      delete slot_it->second.thread_ptr;
+      boost::lock_guard<boost::mutex> guard(concurrency_slots_[i].mtx);
+      takePendingGoal(concurrency_slots_[i], pending_goals);
+      executions.push_back(concurrency_slots_[i].execution);
+    }
+
+    cancelPendingGoals(pending_goals, "Action server shutting down");
+
+    // cancel and join all spawned threads.
+    for (size_t i = 0; i < executions.size(); ++i)
+    {
+      if (executions[i])
+        executions[i]->cancel();
+    }
+    threads_.join_all();
+
+    // unregister and delete
+    for (size_t i = 0; i < concurrency_slots_.size(); ++i)
+    {
+      boost::lock_guard<boost::mutex> guard(concurrency_slots_[i].mtx);
+      if (concurrency_slots_[i].thread_ptr)
+      {
+        threads_.remove_thread(concurrency_slots_[i].thread_ptr);
+        delete concurrency_slots_[i].thread_ptr;
+      }
     }
   }
 
@@ -129,58 +150,80 @@ public:
       typename Execution::Ptr execution_ptr
   )
   {
-    uint8_t slot = goal_handle.getGoal()->concurrency_slot;
-
     if(goal_handle.getGoalStatus().status == actionlib_msgs::GoalStatus::RECALLING)
     {
       goal_handle.setCanceled();
+      return;
     }
-    else
-    {
-      boost::lock_guard<boost::mutex> guard(slot_map_mtx_);
-      typename ConcurrencyMap::iterator slot_it = concurrency_slots_.find(slot);
-      if (slot_it != concurrency_slots_.end() && slot_it->second.in_use) {
-        // if there is already a plugin running on the same slot, cancel it
-        slot_it->second.execution->cancel();
-
-        // WARNING: this will block the main thread for an arbitrary time during which we won't execute callbacks
-        if (slot_it->second.thread_ptr->joinable()) {
-          slot_it->second.thread_ptr->join();
-        }
-      }
 
-      if(slot_it != concurrency_slots_.end())
+    ConcurrencySlot &slot = concurrency_slots_[goal_handle.getGoal()->concurrency_slot];
+
+    typename Execution::Ptr preempted_execution;
+    std::vector<GoalHandle> replaced_goals;
+    {
+      boost::lock_guard<boost::mutex> guard(slot.mtx);
+      if (slot.in_use)
       {
-        // cleanup previous execution; otherwise we will leak threads
-        threads_.remove_thread(concurrency_slots_[slot].thread_ptr);
-        delete concurrency_slots_[slot].thread_ptr;
+        // if there is already a plugin running on the same slot, cancel it and queue the new goal on the slot;
+        // the slot thread will run it as soon as the current execution finishes. We don't wait for that here,
+        // so we don't block the other action callbacks for an arbitrary time
+        takePendingGoal(slot, replaced_goals);  // a newer goal replaces the one already queued, if any
+        slot.has_pending = true;
+        slot.pending_goal_handle = goal_handle;
+        slot.pending_goal_handle.setAccepted();
+        slot.pending_execution = execution_ptr;
+        preempted_execution = slot.execution;
       }
       else
       {
-        // create a new map object in order to avoid costly lookups
-        // note: currently unchecked
-        slot_it = concurrency_slots_.insert(std::make_pair(slot, ConcurrencySlot())).first;
+        if(slot.thread_ptr)
+        {
+          // cleanup previous execution; otherwise we will leak threads
+          threads_.remove_thread(slot.thread_ptr);
+          delete slot.thread_ptr;
+        }
+
+        // fill concurrency slot with the new goal handle, execution, and working thread
+        slot.in_use = true;
+        slot.goal_handle = goal_handle;
+        slot.goal_handle.setAccepted();
+        slot.execution = execution_ptr;
+        slot.thread_ptr = threads_.create_thread(boost::bind(&AbstractActionBase::run, this, boost::ref(slot)));
       }
+    }
 
-      // fill concurrency slot with the new goal handle, execution, and working thread
-      slot_it->second.in_use = true;
-      slot_it->second.goal_handle = goal_handle;
-      slot_it->second.goal_handle.setAccepted();
-      slot_it->second.execution = execution_ptr;
-      slot_it->second.thread_ptr =
-        threads_.create_thread(boost::bind(&AbstractActionBase::run, this, boost::ref(concurrency_slots_[slot])));
+    // out of the lock, as canceling can take a while
+    cancelPendingGoals(replaced_goals, "Goal preempted by a newer goal before starting");
+    if (preempted_execution)
+    {
+      preempted_execution->cancel();
     }
   }
 
   virtual void cancel(GoalHandle &goal_handle)
   {
-    uint8_t slot = goal_handle.getGoal()->concurrency_slot;
+    ConcurrencySlot &slot = concurrency_slots_[goal_handle.getGoal()->concurrency_slot];
 
-    boost::lock_guard<boost::mutex> guard(slot_map_mtx_);
-    typename ConcurrencyMap::iterator slot_it = concurrency_slots_.find(slot);
-    if (slot_it != concurrency_slots_.end())
+    typename Execution::Ptr execution;
+    std::vector<GoalHandle> pending_goals;
     {
-      concurrency_slots_[slot].execution->cancel();
+      boost::lock_guard<boost::mutex> guard(slot.mtx);
+      if (slot.has_pending && slot.pending_goal_handle == goal_handle)
+      {
+        // the goal is still queued; just drop it
+        takePendingGoal(slot, pending_goals);
+      }
+      else
+      {
+        execution = slot.execution;
+      }
+    }
+
+    // out of the lock, as canceling can take a while
+    cancelPendingGoals(pending_goals, "Goal canceled before starting");
+    if (execution)
+    {
+      execution->cancel();
     }
   }
 
@@ -188,47 +231,113 @@ public:
 
   virtual void run(ConcurrencySlot &slot)
   {
-    slot.execution->preRun();
-    runImpl(slot.goal_handle, *slot.execution);
-    ROS_DEBUG_STREAM_NAMED(name_, "Finished action \"" << name_ << "\" run method, waiting for execution thread to finish.");
-    slot.execution->join();
-    ROS_DEBUG_STREAM_NAMED(name_, "Execution completed with goal status "
-                           << (int)slot.goal_handle.getGoalStatus().status << ": "<< slot.goal_handle.getGoalStatus().text);
-    slot.execution->postRun();
-    slot.in_use = false;
+    while (true)
+    {
+      slot.execution->preRun();
+      runImpl(slot.goal_handle, *slot.execution);
+      ROS_DEBUG_STREAM_NAMED(name_, "Finished action \"" << name_ << "\" run method, waiting for execution thread to finish.");
+      slot.execution->join();
+      ROS_DEBUG_STREAM_NAMED(name_, "Execution completed with goal status "
+                             << (int)slot.goal_handle.getGoalStatus().status << ": "<< slot.goal_handle.getGoalStatus().text);
+      slot.execution->postRun();
+
+      boost::lock_guard<boost::mutex> guard(slot.mtx);
+      if (!slot.has_pending)
+      {
+        slot.in_use = false;
+        return;
+      }
+
+      // a new goal has been queued on the slot while we were running the previous one; run it now
+      ROS_DEBUG_STREAM_NAMED(name_, "Starting the goal queued on the slot of action \"" << name_ << "\"");
+      slot.execution = slot.pending_execution;
+      slot.goal_handle = slot.pending_goal_handle;
+      slot.pending_execution.reset();
+      slot.pending_goal_handle = GoalHandle();
+      slot.has_pending = false;
+    }
   }
 
   virtual void reconfigure(mbf_abstract_nav::MoveBaseFlexConfig& config, uint32_t level)
   {
-    boost::lock_guard<boost::mutex> guard(slot_map_mtx_);
-
-    typename ConcurrencyMap::iterator iter;
-    for(iter = concurrency_slots_.begin(); iter != concurrency_slots_.end(); ++iter)
+    for (size_t i = 0; i < concurrency_slots_.size(); ++i)
     {
-      iter->second.execution->reconfigure(config);
+      ConcurrencySlot &slot = concurrency_slots_[i];
+      boost::lock_guard<boost::mutex> guard(slot.mtx);
+      if (slot.execution)
+      {
+        slot.execution->reconfigure(config);
+      }
+      if (slot.has_pending)
+      {
+        slot.pending_execution->reconfigure(config);
+      }
     }
   }
 
   virtual void cancelAll()
   {
     ROS_INFO_STREAM_NAMED(name_, "Cancel all goals for \"" << name_ << "\".");
-    boost::lock_guard<boost::mutex> guard(slot_map_mtx_);
-    typename ConcurrencyMap::iterator iter;
-    for(iter = concurrency_slots_.begin(); iter != concurrency_slots_.end(); ++iter)
+    std::vector<typename Execution::Ptr> executions;
+    std::vector<GoalHandle> pending_goals;
+    for (size_t i = 0; i < concurrency_slots_.size(); ++i)
     {
-      iter->second.execution->cancel();
+      boost::lock_guard<boost::mutex> guard(concurrency_slots_[i].mtx);
+      takePendingGoal(concurrency_slots_[i], pending_goals);
+      if (concurrency_slots_[i].execution)
+      {
+        executions.push_back(concurrency_slots_[i].execution);
+      }
+    }
+
+    // note: we cannot join while holding the slot mutexes, as the slot threads lock them when they finish
+    cancelPendingGoals(pending_goals, "Goal canceled before starting");
+    for (size_t i = 0; i < executions.size(); ++i)
+    {
+      executions[i]->cancel();
     }
     threads_.join_all();
   }
 
 protected:
+
+  /**
+   * @brief Removes the goal queued on a slot, if any. Must be called with the slot mutex locked.
+   * @param slot The slot to remove the queued goal from
+   * @param pending_goals The removed goal handle is appended here, to be canceled afterwards, out of the lock
+   */
+  void takePendingGoal(ConcurrencySlot &slot, std::vector<GoalHandle> &pending_goals)
+  {
+    if (slot.has_pending)
+    {
+      pending_goals.push_back(slot.pending_goal_handle);
+      slot.pending_execution.reset();
+      slot.pending_goal_handle = GoalHandle();
+      slot.has_pending = false;
+    }
+  }
+
+  /**
+   * @brief Sets as canceled goals that have been queued on a slot but never started.
+   * @param pending_goals The goals to cancel
+   * @param message Explanation of why the goals have been canceled
+   */
+  void cancelPendingGoals(std::vector<GoalHandle> &pending_goals, const std::string &message)
+  {
+    for (size_t i = 0; i < pending_goals.size(); ++i)
+    {
+      Result result;
+      result.outcome = Result::CANCELED;
+      result.message = message;
+      pending_goals[i].setCanceled(result, result.message);
+    }
+  }
+
   const std::string &name_;
   const mbf_utility::RobotInformation &robot_info_;
 
   boost::thread_group threads_;
-  ConcurrencyMap concurrency_slots_;
-
-  boost::mutex slot_map_mtx_;
+  ConcurrencySlots concurrency_slots_;
 
 };
 
@@ -45,6 +45,9 @@
 #include <string>
 #include <vector>
 
+#include <boost/circular_buffer.hpp>
+
+#include <diagnostic_msgs/DiagnosticStatus.h>
 #include <geometry_msgs/PoseStamped.h>
 #include <geometry_msgs/Twist.h>
 
@@ -79,12 +82,83 @@ namespace mbf_abstract_nav
 
     typedef boost::shared_ptr<AbstractControllerExecution > Ptr;
 
+    /**
+     * @brief Static (not dynamically reconfigurable) parameters of the controller executions. They are read once
+     *        by the navigation server and shared by all its executions, so creating a new execution doesn't query
+     *        the parameter server.
+     */
+    struct Settings
+    {
+      typedef boost::shared_ptr<const Settings> ConstPtr;
+
+      /**
+       * @brief Reads the settings from the parameter server.
+       * @param private_nh Node handle on the namespace of the navigation server
+       */
+      void loadParams(const ros::NodeHandle &private_nh);
+
+      /**
+       * @brief Creates the settings with the values from the parameter server.
+       * @param private_nh Node handle on the namespace of the navigation server
+       * @return Shared pointer to the new settings
+       */
+      static ConstPtr load(const ros::NodeHandle &private_nh);
+
+      std::string robot_frame;
+      std::string global_frame;
+      bool force_stop_at_goal;
+      bool force_stop_on_retry;
+      bool force_stop_on_cancel;
+      bool mbf_tolerance_check;
+      double dist_tolerance;
+      double angle_tolerance;
+      double tf_timeout;
+      double cmd_vel_ignored_tolerance;
+      bool latency_compensation;
+      double cmd_vel_publish_frequency;
+      bool cmd_vel_interpolation;
+      double cmd_vel_republish_timeout;
+    };
+
+    /**
+     * @brief Statistics of the latency compensation, to evaluate how well the predicted poses track the robot.
+     */
+    struct LatencyCompensationStats
+    {
+      LatencyCompensationStats()
+        : compute_latency(0.0), last_dist_error(0.0), last_angle_error(0.0),
+          mean_dist_error(0.0), mean_angle_error(0.0), samples(0) {}
+
+      double compute_latency;   ///< Smoothed duration of the plugin calls, in seconds; used as prediction horizon
+      double last_dist_error;   ///< Position error of the last prediction, in meters
+      double last_angle_error;  ///< Orientation error of the last prediction, in radians
+      double mean_dist_error;   ///< Mean position error of the predictions since the execution started
+      double mean_angle_error;  ///< Mean orientation error of the predictions since the execution started
+      unsigned int samples;     ///< Number of predictions evaluated since the execution started
+    };
+
+    /**
+     * @brief Constructor; reads the static parameters from the parameter server.
+     * @param name Name of this execution
+     * @param controller_ptr Pointer to the controller plugin
+     * @param robot_info Current robot state
+     * @param vel_pub Velocity publisher
+     * @param config Initial configuration for this execution
+     */
+    AbstractControllerExecution(
+        const std::string &name,
+        const mbf_abstract_core::AbstractController::Ptr &controller_ptr,
+        const mbf_utility::RobotInformation &robot_info,
+        const ros::Publisher &vel_pub,
+        const MoveBaseFlexConfig &config);
+
     /**
      * @brief Constructor
      * @param name Name of this execution
      * @param controller_ptr Pointer to the controller plugin
      * @param robot_info Current robot state
      * @param vel_pub Velocity publisher
+     * @param settings Static parameters, shared by all the executions
      * @param config Initial configuration for this execution
      */
     AbstractControllerExecution(
@@ -92,6 +166,7 @@ namespace mbf_abstract_nav
         const mbf_abstract_core::AbstractController::Ptr &controller_ptr,
         const mbf_utility::RobotInformation &robot_info,
         const ros::Publisher &vel_pub,
+        const Settings::ConstPtr &settings,
         const MoveBaseFlexConfig &config);
 
     /**
@@ -128,6 +203,12 @@ namespace mbf_abstract_nav
      */
     virtual bool cancel();
 
+    /**
+     * @brief Clears the state left by the previous goal, so the execution can be reused for a new one. Keeps the
+     *        storage reserved for the plan.
+     */
+    virtual void reset();
+
     /**
      * @brief Internal states
      */
@@ -196,6 +277,20 @@ namespace mbf_abstract_nav
      */
     bool isMoving() const;
 
+    /**
+     * @brief Returns the statistics of the latency compensation. Thread communication safe.
+     * @return The current latency compensation statistics; the errors are zero if it's disabled
+     */
+    LatencyCompensationStats getLatencyCompensationStats() const;
+
+    /**
+     * @brief Returns the health of the control loop: OK if the controller keeps up with controller_frequency within
+     *        controller_max_utilization, WARN if the loop rate had to be lowered or the utilization is exceeded, and
+     *        ERROR if the controller misses its deadlines even at controller_min_frequency. Thread communication safe.
+     * @return Health status, with the current loop rate and compute time statistics as values
+     */
+    diagnostic_msgs::DiagnosticStatus getHealth() const;
+
   protected:
 
     /**
@@ -249,6 +344,9 @@ namespace mbf_abstract_nav
     //! The time / duration of patience, before changing the state.
     ros::Duration patience_;
 
+    //! whether the plugin gets the robot pose predicted at the time its command will be published
+    bool latency_compensation_;
+
     //! the frame of the robot, which will be used to determine its position.
     std::string robot_frame_;
 
@@ -256,7 +354,8 @@ namespace mbf_abstract_nav
     std::string global_frame_;
 
     /**
-     * @brief The main run method, a thread will execute this method. It contains the main controller execution loop.
+     * @brief The main run method, a thread will execute this method. Runs the main controller execution loop and,
+     *        if enabled, the velocity commands republisher. Waits for any plan preparation to finish.
      */
     virtual void run();
 
@@ -271,12 +370,70 @@ namespace mbf_abstract_nav
 
   private:
 
+    /**
+     * @brief The main controller execution loop.
+     */
+    void controlLoop();
 
     /**
      * @brief Publishes a velocity command with zero values to stop the robot.
      */
     void publishZeroVelocity();
 
+    /**
+     * @brief Starts preparing a new plan on a side thread, so the controller keeps following the current one
+     *        meanwhile. Only used with controllers supporting plan preparation.
+     * @param plan The plan to prepare
+     */
+    void startPlanPreparation(const std::vector<geometry_msgs::PoseStamped> &plan);
+
+    /**
+     * @brief Takes the result of the plan preparation, if it has finished.
+     * @param prepared Whether the controller could prepare the plan
+     * @return true if the preparation has finished, false if it's still running or there's none
+     */
+    bool takePlanPreparationResult(bool &prepared);
+
+    /**
+     * @brief Returns whether a plan is being prepared, or it's already prepared but not committed yet.
+     */
+    bool isPreparingPlan() const;
+
+    /**
+     * @brief Waits for the plan preparation to finish, if any, and discards its result.
+     */
+    void stopPlanPreparation();
+
+    /**
+     * @brief Plan preparation thread; calls the controller's preparePlan.
+     * @param plan The plan to prepare
+     */
+    void planPreparationThread(std::vector<geometry_msgs::PoseStamped> plan);
+
+    /**
+     * @brief Publishes a velocity command. If the republisher is enabled, it becomes the command republished at
+     *        its own rate; the republisher then ramps to it over a controller period if interpolation is enabled,
+     *        and otherwise we publish it right away. Stop commands are always published right away.
+     * @param cmd_vel The velocity command to publish
+     */
+    void publishVelocityCmd(const geometry_msgs::Twist &cmd_vel);
+
+    /**
+     * @brief Starts the thread republishing the velocity commands at cmd_vel_publish_frequency, if enabled.
+     */
+    void startCmdVelRepublisher();
+
+    /**
+     * @brief Stops the velocity commands republisher thread and waits for it to finish.
+     */
+    void stopCmdVelRepublisher();
+
+    /**
+     * @brief Republishes the latest velocity command at a fixed rate, interpolated from the previous one if enabled,
+     *        until stopped or the latest command is older than cmd_vel_republish_timeout.
+     */
+    void cmdVelRepublisherThread();
+
     /**
      * @brief Checks whether the goal has been reached in the range of tolerance or not
      * @return true if the goal has been reached, false otherwise
@@ -289,6 +446,36 @@ namespace mbf_abstract_nav
      */
     void setState(ControllerState state);
 
+    /**
+     * @brief Predicts the robot pose at the time the velocity command being computed will be published, that is,
+     *        after the expected plugin computing time.
+     * @param robot_velocity Current robot velocity
+     * @param predicted_pose The predicted robot pose
+     * @return false if we have no estimation of the computing time yet, true otherwise
+     */
+    bool predictCommandPose(const geometry_msgs::TwistStamped &robot_velocity,
+                            geometry_msgs::PoseStamped &predicted_pose) const;
+
+    /**
+     * @brief Updates the latency compensation statistics with the duration of the last plugin call and, if a
+     *        predicted pose was used, with its error with respect to the current robot pose.
+     * @param compute_time Duration of the last plugin call
+     * @param predicted_pose Pose given to the plugin, or nullptr if we didn't predict it
+     * @param robot_velocity Robot velocity used for the prediction
+     */
+    void updateLatencyCompensation(const ros::Duration &compute_time,
+                                   const geometry_msgs::PoseStamped *predicted_pose,
+                                   const geometry_msgs::TwistStamped &robot_velocity);
+
+    /**
+     * @brief Adapts the loop rate to the compute time distribution, and updates the control loop health. Once we
+     *        have a full window of samples, lowers the rate if their 90th percentile exceeds the allowed utilization
+     *        of the period, and raises it back gradually if there's ample headroom. The rate is kept between
+     *        controller_min_frequency and controller_frequency; the governor is disabled if the former is zero.
+     * @param compute_time Duration of the last plugin call
+     */
+    void governLoopRate(const ros::Duration &compute_time);
+
     //! mutex to handle safe thread communication for the current value of the state
     mutable boost::mutex state_mtx_;
 
@@ -301,6 +488,9 @@ namespace mbf_abstract_nav
     //! mutex to handle safe thread communication for the last plugin call time
     mutable boost::mutex lct_mtx_;
 
+    //! mutex to handle safe thread communication for the latency compensation statistics
+    mutable boost::mutex latency_stats_mtx_;
+
     //! true, if a new plan is available. See hasNewPlan()!
     bool new_plan_;
 
@@ -335,7 +525,26 @@ namespace mbf_abstract_nav
     double tf_timeout_;
 
     //! dynamic reconfigure config mutex, thread safe param reading and writing
-    boost::mutex configuration_mutex_;
+    mutable boost::mutex configuration_mutex_;
+
+    //! configured loop rate, and lowest rate the governor can lower it to; the governor is disabled if zero
+    double max_frequency_;
+    double min_frequency_;
+
+    //! maximum fraction of the loop period the controller should spend computing
+    double max_utilization_;
+
+    //! current loop rate, as adapted by the governor
+    double frequency_;
+
+    //! durations of the latest plugin calls, in seconds
+    boost::circular_buffer<double> compute_times_;
+
+    //! number of plugin calls the governor considers to adapt the loop rate
+    static const size_t GOVERNOR_WINDOW;
+
+    //! current health of the control loop
+    diagnostic_msgs::DiagnosticStatus health_;
 
     //! main controller loop variable, true if the controller is running, false otherwise
     bool moving_;
@@ -374,6 +583,57 @@ namespace mbf_abstract_nav
     //! time tolerance for checking if the robot is ignoring cmd_vel
     double cmd_vel_ignored_tolerance_;
 
+    //! smoothed plugin computing time and prediction errors
+    LatencyCompensationStats latency_stats_;
+
+    //! weight of the last plugin call on the smoothed computing time
+    static const double LATENCY_SMOOTHING;
+
+    //! rate at which the velocity commands are republished, decoupled from the plugin calls; disabled if zero
+    double cmd_vel_publish_frequency_;
+
+    //! whether the republisher ramps from the previous velocity command to the latest one
+    bool cmd_vel_interpolation_;
+
+    //! the republisher stops republishing commands older than this time, so the robot base watchdog can act
+    double cmd_vel_republish_timeout_;
+
+    //! thread republishing the velocity commands while the control loop runs
+    boost::thread cmd_vel_thread_;
+
+    //! mutex and condition variable to handle safe thread communication with the republisher
+    boost::mutex cmd_vel_out_mtx_;
+    boost::condition_variable cmd_vel_out_cv_;
+
+    //! true while the republisher thread must keep running
+    bool cmd_vel_republishing_;
+
+    //! command published when the latest one arrived; the republisher ramps from it to the latest one
+    geometry_msgs::Twist cmd_vel_from_;
+
+    //! latest command from the control loop, and the time it arrived
+    geometry_msgs::Twist cmd_vel_target_;
+    ros::Time cmd_vel_target_time_;
+
+    //! duration of the ramp from cmd_vel_from_ to cmd_vel_target_; a controller period
+    ros::Duration cmd_vel_ramp_time_;
+
+    //! last command published
+    geometry_msgs::Twist cmd_vel_out_;
+
+    //! thread preparing a new plan while the control loop follows the current one
+    boost::thread plan_preparation_thread_;
+
+    //! mutex to handle safe thread communication with the plan preparation thread
+    mutable boost::mutex plan_preparation_mtx_;
+
+    //! true from the start of a plan preparation until its result is taken
+    bool preparing_plan_;
+
+    //! true once the plan preparation has finished, and whether the controller could prepare the plan
+    bool plan_preparation_done_;
+    bool plan_prepared_;
+
   };
 
 } /* namespace mbf_abstract_nav */
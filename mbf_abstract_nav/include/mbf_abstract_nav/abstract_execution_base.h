@@ -78,6 +78,12 @@ class AbstractExecutionBase
 
    void join();
 
+   /**
+    * @brief Joins the execution thread if it has already finished, without waiting for it otherwise.
+    * @return true if the execution thread is not running
+    */
+   bool tryJoin();
+
    boost::cv_status waitForStateUpdate(boost::chrono::microseconds const& duration);
 
    /**
@@ -105,6 +111,12 @@ class AbstractExecutionBase
     */
    virtual void postRun(){};
 
+   /**
+    * @brief Clears the state left by the previous run, so the execution can be reused for a new goal.
+    *        Waits for the execution thread to finish, if still running.
+    */
+   virtual void reset();
+
    /**
     * @brief Optional implementation-specific configuration function.
     */
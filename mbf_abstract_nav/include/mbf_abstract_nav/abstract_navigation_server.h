@@ -41,8 +41,11 @@
 #ifndef MBF_ABSTRACT_NAV__ABSTRACT_NAVIGATION_SERVER_H_
 #define MBF_ABSTRACT_NAV__ABSTRACT_NAVIGATION_SERVER_H_
 
+#include <map>
 #include <string>
+#include <vector>
 
+#include <boost/make_shared.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread/recursive_mutex.hpp>
 
@@ -54,13 +57,16 @@
 
 #include "mbf_abstract_nav/abstract_plugin_manager.h"
 #include "mbf_abstract_nav/abstract_planner_execution.h"
+#include "mbf_abstract_nav/planner_race_execution.h"
 #include "mbf_abstract_nav/abstract_controller_execution.h"
 #include "mbf_abstract_nav/abstract_recovery_execution.h"
+#include "mbf_abstract_nav/execution_pool.hpp"
 
 #include "mbf_abstract_nav/planner_action.h"
 #include "mbf_abstract_nav/controller_action.h"
 #include "mbf_abstract_nav/recovery_action.h"
 #include "mbf_abstract_nav/move_base_action.h"
+#include "mbf_abstract_nav/navigation_action_client.hpp"
 
 #include "mbf_abstract_nav/MoveBaseFlexConfig.h"
 
@@ -143,6 +149,14 @@ typedef boost::shared_ptr<dynamic_reconfigure::Server<mbf_abstract_nav::MoveBase
         const std::string &plugin_name,
         const mbf_abstract_core::AbstractPlanner::Ptr &plugin_ptr);
 
+    /**
+     * @brief Create a new planner race execution, with a new planner execution for each of the race planners.
+     * @param race_name Name of the planner race to run, as configured on the planner_races parameter.
+     * @return Shared pointer to a new @ref planner_execution "PlannerExecution", or an empty pointer if some of the
+     *         race planners is not loaded.
+     */
+    virtual mbf_abstract_nav::AbstractPlannerExecution::Ptr newPlannerRaceExecution(const std::string &race_name);
+
     /**
      * @brief Create a new abstract controller execution.
      * @param plugin_name Name of the controller to use.
@@ -271,6 +285,14 @@ typedef boost::shared_ptr<dynamic_reconfigure::Server<mbf_abstract_nav::MoveBase
 
   protected:
 
+    /**
+     * @brief Loads the planner races given on the planner_races parameter. Each race is a struct with the fields
+     *        "name", "planners" (the names of the loaded planners to race), "mode" ("first" or "best") and "deadline"
+     *        (in seconds; zero or missing for none). Races are requested on get_path goals by their name, as planners.
+     * @return true, if all the races have been loaded, false otherwise
+     */
+    bool loadPlannerRaces();
+
     /**
      * @brief Transforms a plan to the global frame (global_frame_) coord system.
      * @param plan Input plan to be transformed.
@@ -280,6 +302,29 @@ typedef boost::shared_ptr<dynamic_reconfigure::Server<mbf_abstract_nav::MoveBase
     bool transformPlanToGlobalFrame(std::vector<geometry_msgs::PoseStamped> &plan,
                                     std::vector<geometry_msgs::PoseStamped> &global_plan);
 
+    /**
+     * @brief Creates the client used by the move_base action to call one of the other actions. If the parameter
+     *        intra_process_move_base is true, the client calls the given callbacks of this server directly,
+     *        otherwise it goes through the action server topics, as any other client.
+     * @param action_name Name of the action to call
+     * @param goal_cb Server callback for new goals of the action
+     * @param cancel_cb Server callback for cancel requests of the action
+     * @return Shared pointer to the new client
+     */
+    template <typename Action>
+    typename NavigationActionClient<Action>::Ptr newMoveBaseActionClient(
+        const std::string &action_name,
+        void (AbstractNavigationServer::*goal_cb)(actionlib::ServerGoalHandle<Action>),
+        void (AbstractNavigationServer::*cancel_cb)(actionlib::ServerGoalHandle<Action>))
+    {
+      if (intra_process_move_base_)
+      {
+        return boost::make_shared<InProcessActionClient<Action> >(boost::bind(goal_cb, this, _1),
+                                                                  boost::bind(cancel_cb, this, _1));
+      }
+      return boost::make_shared<RosActionClient<Action> >(private_nh_, action_name);
+    }
+
     /**
      * @brief Start a dynamic reconfigure server.
      * This must be called only if the extending doesn't create its own.
@@ -300,6 +345,17 @@ typedef boost::shared_ptr<dynamic_reconfigure::Server<mbf_abstract_nav::MoveBase
     AbstractPluginManager<mbf_abstract_core::AbstractController> controller_plugin_manager_;
     AbstractPluginManager<mbf_abstract_core::AbstractRecovery> recovery_plugin_manager_;
 
+    //! configuration of a planner race
+    struct PlannerRace
+    {
+      std::vector<std::string> planners;
+      PlannerRaceExecution::RaceMode mode;
+      ros::Duration deadline;
+    };
+
+    //! planner races that can be requested on get_path goals, by name
+    std::map<std::string, PlannerRace> planner_races_;
+
     //! shared pointer to the Recovery action server
     ActionServerRecoveryPtr action_server_recovery_ptr_;
 
@@ -345,6 +401,20 @@ typedef boost::shared_ptr<dynamic_reconfigure::Server<mbf_abstract_nav::MoveBase
     //! current robot state
     mbf_utility::RobotInformation robot_info_;
 
+    //! true, if the move_base action calls the other actions directly, instead of through their action servers
+    bool intra_process_move_base_;
+
+    //! static parameters of the planner executions, read once on startup
+    AbstractPlannerExecution::Settings::ConstPtr planner_settings_;
+
+    //! static parameters of the controller executions, read once on startup
+    AbstractControllerExecution::Settings::ConstPtr controller_settings_;
+
+    //! idle executions of finished goals, reused on new goals instead of creating new ones
+    ExecutionPool<AbstractPlannerExecution> planner_execution_pool_;
+    ExecutionPool<AbstractControllerExecution> controller_execution_pool_;
+    ExecutionPool<AbstractRecoveryExecution> recovery_execution_pool_;
+
     ControllerAction controller_action_;
     PlannerAction planner_action_;
     RecoveryAction recovery_action_;
@@ -45,6 +45,8 @@
 #include <string>
 #include <vector>
 
+#include <boost/function.hpp>
+
 #include <geometry_msgs/PoseStamped.h>
 
 #include <mbf_abstract_core/abstract_planner.h>
@@ -78,16 +80,56 @@ namespace mbf_abstract_nav
     //! shared pointer type to the @ref planner_execution "planner execution".
     typedef boost::shared_ptr<AbstractPlannerExecution > Ptr;
 
+    /**
+     * @brief Static (not dynamically reconfigurable) parameters of the planner executions. They are read once by
+     *        the navigation server and shared by all its executions, so creating a new execution doesn't query the
+     *        parameter server.
+     */
+    struct Settings
+    {
+      typedef boost::shared_ptr<const Settings> ConstPtr;
+
+      /**
+       * @brief Reads the settings from the parameter server.
+       * @param private_nh Node handle on the namespace of the navigation server
+       */
+      void loadParams(const ros::NodeHandle &private_nh);
+
+      /**
+       * @brief Creates the settings with the values from the parameter server.
+       * @param private_nh Node handle on the namespace of the navigation server
+       * @return Shared pointer to the new settings
+       */
+      static ConstPtr load(const ros::NodeHandle &private_nh);
+
+      std::string robot_frame;
+      std::string global_frame;
+    };
+
+    /**
+     * @brief Constructor; reads the static parameters from the parameter server.
+     * @param name Name of this execution
+     * @param planner_ptr Pointer to the planner
+     * @param robot_info Current robot state
+     * @param config Initial configuration for this execution
+     */
+    AbstractPlannerExecution(const std::string& name,
+                             const mbf_abstract_core::AbstractPlanner::Ptr& planner_ptr,
+                             const mbf_utility::RobotInformation &robot_info,
+                             const MoveBaseFlexConfig& config);
+
     /**
      * @brief Constructor
      * @param name Name of this execution
      * @param planner_ptr Pointer to the planner
      * @param robot_info Current robot state
+     * @param settings Static parameters, shared by all the executions
      * @param config Initial configuration for this execution
      */
     AbstractPlannerExecution(const std::string& name,
                              const mbf_abstract_core::AbstractPlanner::Ptr& planner_ptr,
                              const mbf_utility::RobotInformation &robot_info,
+                             const Settings::ConstPtr& settings,
                              const MoveBaseFlexConfig& config);
 
     /**
@@ -135,6 +177,14 @@ namespace mbf_abstract_nav
      */
     PlanningState getState() const;
 
+    /**
+     * @brief Sets a function to call on every signalling state update, so several executions can be awaited at once.
+     *        It's called from the execution thread after updating the state, without holding any of our locks.
+     *        Reset clears it.
+     * @param callback the function to call, or an empty one to stop calling it
+     */
+    void setStateCallback(const boost::function<void()> &callback);
+
     /**
      * @brief Gets planning frequency
      */
@@ -153,6 +203,12 @@ namespace mbf_abstract_nav
      */
     virtual bool cancel();
 
+    /**
+     * @brief Clears the state left by the previous goal, so the execution can be reused for a new one. Keeps the
+     *        storage reserved for the plan.
+     */
+    virtual void reset();
+
     /**
      * @brief Sets a new goal pose for the planner execution
      * @param goal the new goal pose
@@ -296,6 +352,9 @@ namespace mbf_abstract_nav
     //! current internal state
     PlanningState state_;
 
+    //! called on every signalling state update, if set
+    boost::function<void()> state_callback_;
+
   };
 
 } /* namespace mbf_abstract_nav */
@@ -39,6 +39,9 @@
 #ifndef MBF_ABSTRACT_NAV__ABSTRACT_PLUGIN_MANAGER_H_
 #define MBF_ABSTRACT_NAV__ABSTRACT_PLUGIN_MANAGER_H_
 
+#include <map>
+#include <string>
+
 #include <boost/function.hpp>
 
 namespace mbf_abstract_nav
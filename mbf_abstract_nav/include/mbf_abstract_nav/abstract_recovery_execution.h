@@ -107,6 +107,11 @@ namespace mbf_abstract_nav
      */
     virtual bool cancel();
 
+    /**
+     * @brief Clears the state left by the previous goal, so the execution can be reused for a new one.
+     */
+    virtual void reset();
+
     /**
      * @brief internal state.
      */
@@ -41,9 +41,15 @@
 #ifndef MBF_ABSTRACT_NAV__CONTROLLER_ACTION_H_
 #define MBF_ABSTRACT_NAV__CONTROLLER_ACTION_H_
 
+#include <limits>
+
 #include <actionlib/server/action_server.h>
 
+#include <diagnostic_msgs/DiagnosticStatus.h>
+#include <mbf_msgs/CompactFeedback.h>
 #include <mbf_msgs/ExePathAction.h>
+#include <mbf_utility/oscillation_detector.h>
+#include <mbf_utility/path_progress_tracker.h>
 #include <mbf_utility/robot_information.h>
 
 #include "mbf_abstract_nav/abstract_action_base.hpp"
@@ -72,8 +78,32 @@ public:
   void runImpl(GoalHandle& goal_handle, AbstractControllerExecution& execution);
 
 protected:
-  void publishExePathFeedback(GoalHandle& goal_handle, uint32_t outcome, const std::string& message,
-                              const geometry_msgs::TwistStamped& current_twist);
+  //! State of the exe_path feedback of a running goal; each slot's run keeps its own
+  struct FeedbackState
+  {
+    //! Progress of the robot along the current plan, reported on the feedback
+    mbf_utility::PathProgressTracker path_tracker;
+
+    //! minimum period between feedback messages; zero publishes feedback on every control cycle
+    ros::Duration period;
+
+    //! time and outcome of the last published feedback, to coalesce the feedback within a period
+    ros::Time last_time;
+    uint32_t last_outcome = std::numeric_limits<uint32_t>::max();
+  };
+
+  /**
+   * @brief Publishes the exe_path feedback, unless we already did within the feedback period, in which case this
+   *        intermediate state is dropped, as the next feedback will supersede it. Outcome changes are always
+   *        published immediately. Also updates the robot progress along the plan, so call it on every cycle.
+   * @param goal_handle Goal handle to publish the feedback on
+   * @param feedback_state Feedback state of the goal's run
+   * @param outcome Outcome of the last controller cycle
+   * @param message Message of the last controller cycle
+   * @param current_twist Last velocity command calculated by the controller
+   */
+  void publishExePathFeedback(GoalHandle& goal_handle, FeedbackState& feedback_state, uint32_t outcome,
+                              const std::string& message, const geometry_msgs::TwistStamped& current_twist);
 
   /**
    * @brief Utility method to fill the ExePath action result in a single line
@@ -83,13 +113,19 @@ protected:
    */
   void fillExePathResult(uint32_t outcome, const std::string& message, mbf_msgs::ExePathResult& result);
 
-  boost::mutex goal_mtx_;                  ///< lock goal handle for updating it while running
+  boost::mutex goal_mtx_;                  ///< lock goal handle and parameters for updating them while running
   geometry_msgs::PoseStamped robot_pose_;  ///< Current robot pose
   geometry_msgs::PoseStamped goal_pose_;   ///< Current goal pose
 
   //! Publish the current goal pose (the last pose of the path we are following)
   ros::Publisher goal_pub_;
 
+  //! Publish the health of the control loop (see AbstractControllerExecution::getHealth)
+  ros::Publisher health_pub_;
+
+  //! Publish a compact version of the feedback, for clients on constrained links
+  ros::Publisher compact_feedback_pub_;
+
   //! timeout after an oscillation is detected
   ros::Duration oscillation_timeout_;
 
@@ -98,6 +134,12 @@ protected:
 
   //! minimal rotation to not detect an oscillation
   double oscillation_angle_;
+
+  //! minimal ratio between move distance and traveled path to not detect an oscillation
+  double oscillation_min_path_efficiency_;
+
+  //! minimum period between feedback messages; zero publishes feedback on every control cycle
+  ros::Duration feedback_period_;
 };
 }  // namespace mbf_abstract_nav
 
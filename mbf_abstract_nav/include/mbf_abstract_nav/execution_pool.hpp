@@ -0,0 +1,248 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  execution_pool.hpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_ABSTRACT_NAV__EXECUTION_POOL_HPP_
+#define MBF_ABSTRACT_NAV__EXECUTION_POOL_HPP_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include "mbf_abstract_nav/MoveBaseFlexConfig.h"
+
+namespace mbf_abstract_nav
+{
+
+/**
+ * @brief Pool of idle executions, kept per plugin name, so new goals can reuse the execution objects of finished
+ *        goals instead of constructing new ones. The executions handed out by acquire are given back to the pool
+ *        automatically once the last shared pointer to them is released; on reuse, they are reset and reconfigured
+ *        with the current configuration, but keep their buffers.
+ *
+ *        Only finished executions are pooled, so acquire never waits for an execution thread. Executions released
+ *        while still running (e.g. a planner race loser whose plugin ignores cancel) are awaited on a background
+ *        thread, and given back to the pool once they finish.
+ *
+ *        Executions given back after the pool is destroyed are simply deleted.
+ *
+ * @tparam Execution a class implementing the AbstractExecutionBase, with a Ptr shared pointer type and a
+ *         reconfigure method taking a MoveBaseFlexConfig
+ */
+template <typename Execution>
+class ExecutionPool
+{
+ public:
+  typedef typename Execution::Ptr ExecutionPtr;
+
+  //! function creating a new execution, called when there's none idle to reuse
+  typedef boost::function<ExecutionPtr()> Factory;
+
+  /**
+   * @brief Constructor
+   * @param max_idle Maximum number of idle executions kept for each plugin
+   */
+  explicit ExecutionPool(size_t max_idle = 4) : pool_(boost::make_shared<Pool>(max_idle))
+  {
+  }
+
+  /**
+   * @brief Takes an idle execution for the given plugin, or creates a new one if there's none.
+   * @param name Name of the plugin the execution runs
+   * @param factory Function creating a new execution for the plugin
+   * @param config Current configuration, applied to reused executions
+   * @return Shared pointer to the execution, or an empty pointer if the factory failed
+   */
+  ExecutionPtr acquire(const std::string &name, const Factory &factory, const MoveBaseFlexConfig &config)
+  {
+    ExecutionPtr execution;
+    {
+      boost::lock_guard<boost::mutex> guard(pool_->mutex);
+      std::vector<ExecutionPtr> &idle = pool_->idle[name];
+      if (!idle.empty())
+      {
+        execution = idle.back();
+        idle.pop_back();
+        ++pool_->reused;
+      }
+    }
+
+    if (execution)
+    {
+      // clear the state left by the previous goal and catch up with reconfigurations done while idle; pooled
+      // executions are finished, so this doesn't wait for their threads
+      execution->reset();
+      execution->reconfigure(config);
+    }
+    else
+    {
+      execution = factory();
+      if (!execution)
+      {
+        return execution;
+      }
+      boost::lock_guard<boost::mutex> guard(pool_->mutex);
+      ++pool_->created;
+    }
+
+    // hand out a pointer that gives the execution back to the pool instead of deleting it
+    return ExecutionPtr(execution.get(), Recycler(pool_, name, execution));
+  }
+
+  /**
+   * @brief Deletes all the idle executions.
+   */
+  void clear()
+  {
+    std::map<std::string, std::vector<ExecutionPtr> > idle;
+    {
+      boost::lock_guard<boost::mutex> guard(pool_->mutex);
+      idle.swap(pool_->idle);
+    }
+    // executions get deleted here, out of the lock, as that can take a while
+  }
+
+  /**
+   * @brief Gets the number of executions created because there was none idle to reuse.
+   */
+  size_t getCreatedCount() const
+  {
+    boost::lock_guard<boost::mutex> guard(pool_->mutex);
+    return pool_->created;
+  }
+
+  /**
+   * @brief Gets the number of executions reused.
+   */
+  size_t getReusedCount() const
+  {
+    boost::lock_guard<boost::mutex> guard(pool_->mutex);
+    return pool_->reused;
+  }
+
+  /**
+   * @brief Gets the number of idle executions for the given plugin.
+   */
+  size_t getIdleCount(const std::string &name) const
+  {
+    boost::lock_guard<boost::mutex> guard(pool_->mutex);
+    typename std::map<std::string, std::vector<ExecutionPtr> >::const_iterator it = pool_->idle.find(name);
+    return it == pool_->idle.end() ? 0 : it->second.size();
+  }
+
+ private:
+
+  //! pool contents, shared with the recyclers of the executions handed out
+  struct Pool
+  {
+    explicit Pool(size_t max_idle) : max_idle(max_idle), created(0), reused(0) {}
+
+    mutable boost::mutex mutex;
+    std::map<std::string, std::vector<ExecutionPtr> > idle;
+    size_t max_idle;
+    size_t created;
+    size_t reused;
+  };
+
+  //! deleter of the handed out pointers; it gives the execution back to the pool, if it still exists
+  struct Recycler
+  {
+    Recycler(const boost::shared_ptr<Pool> &pool, const std::string &name, const ExecutionPtr &execution)
+      : pool(pool), name(name), execution(execution)
+    {
+    }
+
+    void operator()(Execution *)
+    {
+      ExecutionPtr released;
+      released.swap(execution);
+
+      if (!released->tryJoin())
+      {
+        // still running; we must not block whoever dropped the last reference (deleting it would join the thread),
+        // so we wait for it to finish in the background
+        boost::thread(&Recycler::recycleWhenDone, pool, name, released).detach();
+        return;
+      }
+      recycle(pool, name, released);
+    }
+
+    static void recycleWhenDone(const boost::weak_ptr<Pool> &pool, const std::string &name, ExecutionPtr released)
+    {
+      released->join();
+      recycle(pool, name, released);
+    }
+
+    static void recycle(const boost::weak_ptr<Pool> &pool, const std::string &name, ExecutionPtr &released)
+    {
+      boost::shared_ptr<Pool> pool_ptr = pool.lock();
+      if (!pool_ptr)
+      {
+        return;
+      }
+
+      boost::lock_guard<boost::mutex> guard(pool_ptr->mutex);
+      std::vector<ExecutionPtr> &idle = pool_ptr->idle[name];
+      if (idle.size() < pool_ptr->max_idle)
+      {
+        idle.push_back(released);
+        released.reset();
+      }
+      // otherwise the execution gets deleted when released goes out of scope, after unlocking
+    }
+
+    boost::weak_ptr<Pool> pool;
+    std::string name;
+    ExecutionPtr execution;
+  };
+
+  boost::shared_ptr<Pool> pool_;
+};
+
+} /* namespace mbf_abstract_nav */
+
+#endif /* MBF_ABSTRACT_NAV__EXECUTION_POOL_HPP_ */
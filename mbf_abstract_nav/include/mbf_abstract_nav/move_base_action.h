@@ -41,16 +41,20 @@
 #define MBF_ABSTRACT_NAV__MOVE_BASE_ACTION_H_
 
 #include <actionlib/server/action_server.h>
-#include <actionlib/client/simple_action_client.h>
 
+#include <diagnostic_msgs/DiagnosticStatus.h>
+
+#include <mbf_msgs/CompactFeedback.h>
 #include <mbf_msgs/MoveBaseAction.h>
 #include <mbf_msgs/GetPathAction.h>
 #include <mbf_msgs/ExePathAction.h>
 #include <mbf_msgs/RecoveryAction.h>
 
+#include <mbf_utility/oscillation_detector.h>
 #include <mbf_utility/robot_information.h>
 
 #include "mbf_abstract_nav/MoveBaseFlexConfig.h"
+#include "mbf_abstract_nav/navigation_action_client.hpp"
 
 
 namespace mbf_abstract_nav
@@ -61,15 +65,27 @@ class MoveBaseAction
  public:
 
   //! Action clients for the MoveBase action
-  typedef actionlib::SimpleActionClient<mbf_msgs::GetPathAction> ActionClientGetPath;
-  typedef actionlib::SimpleActionClient<mbf_msgs::ExePathAction> ActionClientExePath;
-  typedef actionlib::SimpleActionClient<mbf_msgs::RecoveryAction> ActionClientRecovery;
+  typedef NavigationActionClient<mbf_msgs::GetPathAction> ActionClientGetPath;
+  typedef NavigationActionClient<mbf_msgs::ExePathAction> ActionClientExePath;
+  typedef NavigationActionClient<mbf_msgs::RecoveryAction> ActionClientRecovery;
 
   typedef actionlib::ActionServer<mbf_msgs::MoveBaseAction>::GoalHandle GoalHandle;
 
+  /**
+   * @brief Constructor
+   * @param name Name of the action
+   * @param robot_info Current robot state
+   * @param behaviors Names of the loaded recovery behaviors, used when the goal doesn't specify any
+   * @param action_client_get_path Client to call the get_path action; if empty, an actionlib client is created
+   * @param action_client_exe_path Client to call the exe_path action; if empty, an actionlib client is created
+   * @param action_client_recovery Client to call the recovery action; if empty, an actionlib client is created
+   */
   MoveBaseAction(const std::string &name,
                  const mbf_utility::RobotInformation &robot_info,
-                 const std::vector<std::string> &controllers);
+                 const std::vector<std::string> &behaviors,
+                 const ActionClientGetPath::Ptr &action_client_get_path = ActionClientGetPath::Ptr(),
+                 const ActionClientExePath::Ptr &action_client_exe_path = ActionClientExePath::Ptr(),
+                 const ActionClientRecovery::Ptr &action_client_recovery = ActionClientRecovery::Ptr());
 
   ~MoveBaseAction();
 
@@ -100,8 +116,64 @@ class MoveBaseAction
 
   bool attemptRecovery();
 
+  /**
+   * @brief Callback for the get_path goals sent by the replanning thread; sends the new plan to exe_path.
+   * @param state Final state of the get_path goal
+   * @param result Result of the get_path action
+   */
+  void actionGetPathReplanningDone(
+      const actionlib::SimpleClientGoalState &state,
+      const mbf_msgs::GetPathResultConstPtr &result);
+
+  /**
+   * @brief Decides whether a replanned path should replace the one being followed. It does if it's materially
+   *        shorter than what remains of the current path, or if it deviates from it by more than the configured
+   *        divergence, what means that the way ahead has changed. Otherwise we keep the current path, to avoid
+   *        needlessly resetting the controller.
+   * @param new_path The replanned path
+   * @param reason Explanation of the decision, for logging
+   * @return true if the new path should replace the current one
+   */
+  bool acceptReplannedPath(const std::vector<geometry_msgs::PoseStamped> &new_path, std::string &reason) const;
+
+  /**
+   * @brief Predicts the robot pose some time ahead, assuming it keeps its current velocity.
+   * @param horizon How far ahead to predict the robot pose
+   * @param predicted_pose The predicted robot pose
+   * @return true if the robot pose and velocity were available, false otherwise
+   */
+  bool predictRobotPose(const ros::Duration &horizon, geometry_msgs::PoseStamped &predicted_pose) const;
+
   bool replanningActive() const;
 
+  /**
+   * @brief Records the time at which the current goal went through one of the hops between its reception and the
+   *        first velocity command. Does nothing once the goal timeline has been published.
+   * @param hop Name of the hop, used as key on the published timeline
+   * @param stamp Time at which the hop happened
+   */
+  void traceGoalHop(const std::string &hop, const ros::Time &stamp = ros::Time::now());
+
+  /**
+   * @brief Publishes the timeline of the current goal, as latencies in milliseconds relative to the goal reception.
+   *        The goal id is used as trace id. Only the first call for each goal publishes.
+   */
+  void publishGoalTrace();
+
+  /**
+   * @brief Starts tracing a new goal, discarding the timeline of the previous one.
+   */
+  void resetGoalTrace();
+
+  /**
+   * @brief Wakes up the replanning thread, so it reevaluates whether it must replan and when.
+   */
+  void wakeReplanningThread();
+
+  /**
+   * @brief Replanning loop. It blocks while replanning is inactive or a plan is being computed, and otherwise
+   *        sleeps until the next replanning period is due.
+   */
   void replanningThread();
 
   /**
@@ -127,17 +199,15 @@ class MoveBaseAction
   mbf_msgs::GetPathGoal get_path_goal_;
   mbf_msgs::RecoveryGoal recovery_goal_;
 
-  geometry_msgs::PoseStamped last_oscillation_pose_;
-  ros::Time last_oscillation_reset_;
-
-  //! timeout after a oscillation is detected
-  ros::Duration oscillation_timeout_;
+  //! navigation-level oscillation detection, fed with exe_path action feedback
+  mbf_utility::OscillationDetector oscillation_detector_;
 
-  //! minimal move distance to not detect an oscillation
-  double oscillation_distance_;
+  //! mutex to protect the oscillation detector, as it's reconfigured and fed from different threads
+  boost::mutex oscillation_mtx_;
 
-  //! minimal rotation to not detect an oscillation
-  double oscillation_angle_;
+  //! serializes start, cancel and the action clients callbacks, as the latter can run on several threads (e.g. with
+  //! intra-process clients, or with a multi-threaded spinner); recursive, as callbacks can call cancel
+  boost::recursive_mutex action_mtx_;
 
   GoalHandle goal_handle_;
 
@@ -155,24 +225,53 @@ class MoveBaseAction
   ros::NodeHandle private_nh_;
 
   //! Action client used by the move_base action
-  ActionClientExePath action_client_exe_path_;
+  ActionClientExePath::Ptr action_client_exe_path_;
 
   //! Action client used by the move_base action
-  ActionClientGetPath action_client_get_path_;
+  ActionClientGetPath::Ptr action_client_get_path_;
 
   //! Action client used by the move_base action
-  ActionClientRecovery action_client_recovery_;
+  ActionClientRecovery::Ptr action_client_recovery_;
 
-  //! current distance to goal (we will stop replanning if very close to avoid destabilizing the controller)
+  //! current distance to goal along the path (we will stop replanning if very close to avoid destabilizing the
+  //! controller); straight-line distance would stop it too early on winding paths
   double dist_to_goal_;
 
   //! Replanning period dynamically reconfigurable
   ros::Duration replanning_period_;
 
+  //! How far ahead to predict the robot pose used as start of the replanned paths
+  ros::Duration replanning_prediction_horizon_;
+
+  //! Minimum relative reduction of the remaining path length for a replanned path to replace the current one
+  double replanning_min_improvement_;
+
+  //! Replanned paths deviating more than this distance from the current one replace it regardless of their length
+  double replanning_max_divergence_;
+
+  //! mutex and condition variable to wake up the replanning thread
+  boost::mutex replanning_mtx_;
+  boost::condition_variable replanning_cv_;
+
   //! Replanning thread, running permanently
   boost::thread replanning_thread_;
   bool replanning_thread_shutdown_;
 
+  //! hops of the current goal, from its reception to the first velocity command, with the time each one happened
+  std::vector<std::pair<std::string, ros::Time> > goal_trace_;
+
+  //! true once the timeline of the current goal has been published
+  bool goal_trace_published_;
+
+  //! mutex to protect the goal trace, as hops are traced from the action server and the action clients threads
+  boost::mutex goal_trace_mtx_;
+
+  //! publisher for the goal-to-command timeline of each move_base goal
+  ros::Publisher goal_trace_pub_;
+
+  //! publisher for a compact version of the feedback, for clients on constrained links
+  ros::Publisher compact_feedback_pub_;
+
   //! true, if recovery behavior for the MoveBase action is enabled.
   bool recovery_enabled_;
 
@@ -0,0 +1,464 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  navigation_action_client.hpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_ABSTRACT_NAV__NAVIGATION_ACTION_CLIENT_HPP_
+#define MBF_ABSTRACT_NAV__NAVIGATION_ACTION_CLIENT_HPP_
+
+#include <deque>
+#include <string>
+
+#include <boost/chrono.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <actionlib/action_definition.h>
+#include <actionlib/goal_id_generator.h>
+#include <actionlib/client/simple_action_client.h>
+#include <actionlib/server/action_server_base.h>
+
+namespace mbf_abstract_nav
+{
+
+/**
+ * @brief Interface of the clients used by the MoveBaseAction to drive the get_path, exe_path and recovery actions. It
+ *        is the subset of the actionlib::SimpleActionClient API used by the MoveBaseAction, so the actions can be
+ *        called either through actionlib topics or directly within the process.
+ * @tparam Action The action type, e.g. mbf_msgs::ExePathAction
+ */
+template <typename Action>
+class NavigationActionClient
+{
+ public:
+  ACTION_DEFINITION(Action);
+
+  typedef boost::shared_ptr<NavigationActionClient> Ptr;
+
+  typedef typename actionlib::SimpleActionClient<Action>::SimpleDoneCallback DoneCallback;
+  typedef typename actionlib::SimpleActionClient<Action>::SimpleActiveCallback ActiveCallback;
+  typedef typename actionlib::SimpleActionClient<Action>::SimpleFeedbackCallback FeedbackCallback;
+
+  virtual ~NavigationActionClient() {}
+
+  /**
+   * @brief Waits for the action server to be ready.
+   * @param timeout Max time to wait; zero means wait forever
+   * @return true if the server is ready, false otherwise
+   */
+  virtual bool waitForServer(const ros::Duration &timeout) = 0;
+
+  /**
+   * @brief Sends a goal to the action server, replacing the goal currently tracked, if any. The callbacks of a
+   *        replaced goal are not called anymore.
+   * @param goal The goal to send
+   * @param done_cb Callback called once the goal reaches a terminal state
+   * @param active_cb Callback called when the goal gets accepted by the server
+   * @param feedback_cb Callback called for every feedback of the goal
+   */
+  virtual void sendGoal(const Goal &goal,
+                        DoneCallback done_cb = DoneCallback(),
+                        ActiveCallback active_cb = ActiveCallback(),
+                        FeedbackCallback feedback_cb = FeedbackCallback()) = 0;
+
+  /**
+   * @brief Cancels the goal currently tracked.
+   */
+  virtual void cancelGoal() = 0;
+
+  /**
+   * @brief Blocks until the goal currently tracked finishes.
+   * @param timeout Max time to wait; zero means wait forever
+   * @return true if the goal finished, false otherwise
+   */
+  virtual bool waitForResult(const ros::Duration &timeout) = 0;
+
+  /**
+   * @brief Gets the state of the goal currently tracked.
+   * @return the goal state; LOST if no goal has been sent yet
+   */
+  virtual actionlib::SimpleClientGoalState getState() const = 0;
+
+  /**
+   * @brief Gets the result of the goal currently tracked.
+   * @return the result, or an empty pointer if the goal is not done yet
+   */
+  virtual ResultConstPtr getResult() const = 0;
+};
+
+/**
+ * @brief NavigationActionClient going through actionlib topics, as any other client of move_base_flex does.
+ * @tparam Action The action type, e.g. mbf_msgs::ExePathAction
+ */
+template <typename Action>
+class RosActionClient : public NavigationActionClient<Action>
+{
+ public:
+  ACTION_DEFINITION(Action);
+
+  typedef NavigationActionClient<Action> Client;
+
+  /**
+   * @brief Constructor
+   * @param nh Node handle in which namespace the action server lives
+   * @param name Name of the action
+   */
+  RosActionClient(ros::NodeHandle &nh, const std::string &name) : client_(nh, name)
+  {
+  }
+
+  virtual bool waitForServer(const ros::Duration &timeout)
+  {
+    return client_.waitForServer(timeout);
+  }
+
+  virtual void sendGoal(const Goal &goal,
+                        typename Client::DoneCallback done_cb = typename Client::DoneCallback(),
+                        typename Client::ActiveCallback active_cb = typename Client::ActiveCallback(),
+                        typename Client::FeedbackCallback feedback_cb = typename Client::FeedbackCallback())
+  {
+    client_.sendGoal(goal, done_cb, active_cb, feedback_cb);
+  }
+
+  virtual void cancelGoal()
+  {
+    client_.cancelGoal();
+  }
+
+  virtual bool waitForResult(const ros::Duration &timeout)
+  {
+    return client_.waitForResult(timeout);
+  }
+
+  virtual actionlib::SimpleClientGoalState getState() const
+  {
+    return client_.getState();
+  }
+
+  virtual ResultConstPtr getResult() const
+  {
+    return client_.getResult();
+  }
+
+ private:
+  actionlib::SimpleActionClient<Action> client_;
+};
+
+/**
+ * @brief NavigationActionClient that hands the goals directly to the navigation server goal and cancel callbacks,
+ *        without going through actionlib topics. It acts as the actionlib::ActionServerBase the goal handles report
+ *        to, so the results and feedback published by the actions are delivered to the client callbacks without
+ *        any serialization. Callbacks are run in order by a dedicated thread, instead of by the ROS callback queue;
+ *        this way the action threads never block on the client side logic, nor can they deadlock with it.
+ * @tparam Action The action type, e.g. mbf_msgs::ExePathAction
+ */
+template <typename Action>
+class InProcessActionClient : public NavigationActionClient<Action>, public actionlib::ActionServerBase<Action>
+{
+ public:
+  ACTION_DEFINITION(Action);
+
+  typedef NavigationActionClient<Action> Client;
+  typedef actionlib::ServerGoalHandle<Action> GoalHandle;
+
+  /**
+   * @brief Constructor
+   * @param goal_cb Navigation server callback to run on new goals
+   * @param cancel_cb Navigation server callback to run on cancel requests
+   */
+  InProcessActionClient(boost::function<void(GoalHandle)> goal_cb, boost::function<void(GoalHandle)> cancel_cb)
+      : actionlib::ActionServerBase<Action>(goal_cb, cancel_cb, true),
+        state_(actionlib::SimpleClientGoalState::LOST), dispatcher_shutdown_(false)
+  {
+    this->status_list_timeout_ = ros::Duration(5.0);
+    dispatcher_thread_ = boost::thread(&InProcessActionClient::dispatcherThread, this);
+  }
+
+  virtual ~InProcessActionClient()
+  {
+    {
+      boost::lock_guard<boost::mutex> guard(dispatcher_mtx_);
+      dispatcher_shutdown_ = true;
+    }
+    dispatcher_cv_.notify_all();
+    dispatcher_thread_.join();
+  }
+
+  virtual bool waitForServer(const ros::Duration &timeout)
+  {
+    // the server lives in this same process, so it's always there
+    return true;
+  }
+
+  virtual void sendGoal(const Goal &goal,
+                        typename Client::DoneCallback done_cb = typename Client::DoneCallback(),
+                        typename Client::ActiveCallback active_cb = typename Client::ActiveCallback(),
+                        typename Client::FeedbackCallback feedback_cb = typename Client::FeedbackCallback())
+  {
+    ActionGoalPtr action_goal(new ActionGoal());
+    action_goal->header.stamp = ros::Time::now();
+    action_goal->goal_id = goal_id_generator_.generateID();
+    action_goal->goal = goal;
+    {
+      boost::lock_guard<boost::mutex> guard(state_mtx_);
+      goal_id_ = action_goal->goal_id.id;
+      state_ = actionlib::SimpleClientGoalState(actionlib::SimpleClientGoalState::PENDING);
+      result_.reset();
+      done_cb_ = done_cb;
+      active_cb_ = active_cb;
+      feedback_cb_ = feedback_cb;
+    }
+    // the navigation server callback runs on this thread, as it would on the action server's one
+    this->goalCallback(action_goal);
+  }
+
+  virtual void cancelGoal()
+  {
+    boost::shared_ptr<actionlib_msgs::GoalID> goal_id(new actionlib_msgs::GoalID());
+    {
+      boost::lock_guard<boost::mutex> guard(state_mtx_);
+      if (goal_id_.empty())
+      {
+        // an empty id with no stamp would cancel all goals
+        return;
+      }
+      goal_id->id = goal_id_;
+    }
+    this->cancelCallback(goal_id);
+  }
+
+  virtual bool waitForResult(const ros::Duration &timeout)
+  {
+    boost::unique_lock<boost::mutex> lock(state_mtx_);
+    if (goal_id_.empty())
+    {
+      return false;
+    }
+    const boost::chrono::steady_clock::time_point deadline =
+        boost::chrono::steady_clock::now() + boost::chrono::nanoseconds(timeout.toNSec());
+    while (!state_.isDone())
+    {
+      if (timeout.isZero())
+      {
+        result_cv_.wait(lock);
+      }
+      else if (result_cv_.wait_until(lock, deadline) == boost::cv_status::timeout)
+      {
+        break;
+      }
+    }
+    return state_.isDone();
+  }
+
+  virtual actionlib::SimpleClientGoalState getState() const
+  {
+    boost::lock_guard<boost::mutex> guard(state_mtx_);
+    return state_;
+  }
+
+  virtual ResultConstPtr getResult() const
+  {
+    boost::lock_guard<boost::mutex> guard(state_mtx_);
+    return result_;
+  }
+
+ protected:
+  virtual void initialize()
+  {
+  }
+
+  /**
+   * @brief Called by the goal handles when a goal reaches a terminal state.
+   */
+  virtual void publishResult(const actionlib_msgs::GoalStatus &status, const Result &result)
+  {
+    boost::lock_guard<boost::mutex> guard(state_mtx_);
+    if (status.goal_id.id != goal_id_)
+    {
+      return;  // not tracking this goal anymore
+    }
+
+    switch (status.status)
+    {
+      case actionlib_msgs::GoalStatus::SUCCEEDED:
+        state_ = actionlib::SimpleClientGoalState(actionlib::SimpleClientGoalState::SUCCEEDED, status.text);
+        break;
+      case actionlib_msgs::GoalStatus::ABORTED:
+        state_ = actionlib::SimpleClientGoalState(actionlib::SimpleClientGoalState::ABORTED, status.text);
+        break;
+      case actionlib_msgs::GoalStatus::PREEMPTED:
+        state_ = actionlib::SimpleClientGoalState(actionlib::SimpleClientGoalState::PREEMPTED, status.text);
+        break;
+      case actionlib_msgs::GoalStatus::RECALLED:
+        state_ = actionlib::SimpleClientGoalState(actionlib::SimpleClientGoalState::RECALLED, status.text);
+        break;
+      case actionlib_msgs::GoalStatus::REJECTED:
+        state_ = actionlib::SimpleClientGoalState(actionlib::SimpleClientGoalState::REJECTED, status.text);
+        break;
+      default:
+        state_ = actionlib::SimpleClientGoalState(actionlib::SimpleClientGoalState::LOST, status.text);
+        break;
+    }
+    result_.reset(new Result(result));
+    result_cv_.notify_all();
+
+    if (done_cb_)
+    {
+      dispatch(boost::bind(done_cb_, state_, result_));
+    }
+    done_cb_.clear();
+    active_cb_.clear();
+    feedback_cb_.clear();
+  }
+
+  /**
+   * @brief Called by the goal handles on every feedback of a goal.
+   */
+  virtual void publishFeedback(const actionlib_msgs::GoalStatus &status, const Feedback &feedback)
+  {
+    boost::lock_guard<boost::mutex> guard(state_mtx_);
+    if (status.goal_id.id != goal_id_ || !feedback_cb_)
+    {
+      return;
+    }
+    FeedbackConstPtr feedback_ptr(new Feedback(feedback));
+    dispatch(boost::bind(feedback_cb_, feedback_ptr));
+  }
+
+  /**
+   * @brief Called by the goal handles on every status transition. We use it to notify the activation of the tracked
+   *        goal, and to drop the goals no longer referenced from the status list, as the actionlib server does.
+   */
+  virtual void publishStatus()
+  {
+    boost::recursive_mutex::scoped_lock lock(this->lock_);
+    boost::lock_guard<boost::mutex> guard(state_mtx_);
+
+    typename std::list<actionlib::StatusTracker<Action> >::iterator it = this->status_list_.begin();
+    while (it != this->status_list_.end())
+    {
+      if (it->status_.goal_id.id == goal_id_ && state_ == actionlib::SimpleClientGoalState::PENDING &&
+          (it->status_.status == actionlib_msgs::GoalStatus::ACTIVE ||
+           it->status_.status == actionlib_msgs::GoalStatus::PREEMPTING))
+      {
+        state_ = actionlib::SimpleClientGoalState(actionlib::SimpleClientGoalState::ACTIVE);
+        if (active_cb_)
+        {
+          dispatch(active_cb_);
+        }
+      }
+
+      if (it->handle_destruction_time_ != ros::Time() &&
+          it->handle_destruction_time_ + this->status_list_timeout_ < ros::Time::now())
+      {
+        it = this->status_list_.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+  }
+
+ private:
+  /**
+   * @brief Queues a client callback to be run by the dispatcher thread.
+   */
+  void dispatch(const boost::function<void()> &callback)
+  {
+    {
+      boost::lock_guard<boost::mutex> guard(dispatcher_mtx_);
+      callbacks_.push_back(callback);
+    }
+    dispatcher_cv_.notify_one();
+  }
+
+  /**
+   * @brief Runs the queued client callbacks in order, until shutdown.
+   */
+  void dispatcherThread()
+  {
+    boost::unique_lock<boost::mutex> lock(dispatcher_mtx_);
+    while (!dispatcher_shutdown_)
+    {
+      if (callbacks_.empty())
+      {
+        dispatcher_cv_.wait(lock);
+        continue;
+      }
+      boost::function<void()> callback = callbacks_.front();
+      callbacks_.pop_front();
+      lock.unlock();
+      callback();
+      lock.lock();
+    }
+  }
+
+  //! generates the ids of the goals we send
+  actionlib::GoalIDGenerator goal_id_generator_;
+
+  //! id of the goal currently tracked; empty if we haven't sent any
+  std::string goal_id_;
+
+  //! state and result of the goal currently tracked
+  actionlib::SimpleClientGoalState state_;
+  ResultConstPtr result_;
+
+  //! callbacks of the goal currently tracked
+  typename Client::DoneCallback done_cb_;
+  typename Client::ActiveCallback active_cb_;
+  typename Client::FeedbackCallback feedback_cb_;
+
+  //! protects the goal state and callbacks
+  mutable boost::mutex state_mtx_;
+
+  //! notifies the end of the goal currently tracked
+  boost::condition_variable result_cv_;
+
+  //! client callbacks waiting to be run by the dispatcher thread
+  std::deque<boost::function<void()> > callbacks_;
+  boost::mutex dispatcher_mtx_;
+  boost::condition_variable dispatcher_cv_;
+  boost::thread dispatcher_thread_;
+  bool dispatcher_shutdown_;
+};
+
+} /* namespace mbf_abstract_nav */
+
+#endif /* MBF_ABSTRACT_NAV__NAVIGATION_ACTION_CLIENT_HPP_ */
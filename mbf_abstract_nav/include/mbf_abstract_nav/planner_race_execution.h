@@ -0,0 +1,183 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  planner_race_execution.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_ABSTRACT_NAV__PLANNER_RACE_EXECUTION_H_
+#define MBF_ABSTRACT_NAV__PLANNER_RACE_EXECUTION_H_
+
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <geometry_msgs/PoseStamped.h>
+
+#include <mbf_utility/robot_information.h>
+
+#include "mbf_abstract_nav/abstract_planner_execution.h"
+
+namespace mbf_abstract_nav
+{
+
+/**
+ * @brief The PlannerRaceExecution runs several planner executions concurrently against the same start and goal,
+ *        each one on its own thread, and reports the plan of the winner as its own. Depending on the race mode,
+ *        the winner is the first contender finding a plan or the one with the lowest cost once all of them have
+ *        finished or the deadline has expired. The remaining contenders are canceled as soon as the race is decided.
+ *
+ *        The race is seen by the planner action as any other planner execution, so retries, patience and
+ *        canceling work as usual.
+ *
+ * @ingroup abstract_server planner_execution
+ */
+  class PlannerRaceExecution : public AbstractPlannerExecution
+  {
+  public:
+
+    //! shared pointer type to the planner race execution.
+    typedef boost::shared_ptr<PlannerRaceExecution > Ptr;
+
+    enum RaceMode
+    {
+      FIRST,  ///< The first plan found wins the race.
+      BEST    ///< The plan with the lowest cost found before the deadline wins the race.
+    };
+
+    /**
+     * @brief Constructor
+     * @param name Name of the race, used as planner name
+     * @param contenders Planner executions taking part in the race; they must not be running
+     * @param mode How the winner of the race is chosen
+     * @param deadline Maximum time to wait for the contenders. When it expires, the best plan found so far wins,
+     *        if any. Zero means no deadline, so the race lasts until the contenders finish or patience is exceeded.
+     * @param robot_info Current robot state
+     * @param settings Static parameters, shared by all the executions
+     * @param config Initial configuration for this execution
+     */
+    PlannerRaceExecution(const std::string &name,
+                         const std::vector<AbstractPlannerExecution::Ptr> &contenders,
+                         RaceMode mode,
+                         const ros::Duration &deadline,
+                         const mbf_utility::RobotInformation &robot_info,
+                         const Settings::ConstPtr &settings,
+                         const MoveBaseFlexConfig &config);
+
+    virtual ~PlannerRaceExecution();
+
+    /**
+     * @brief Cancel the race, canceling all the contenders still planning.
+     * @return true, if at least one of the contenders tries / tried to cancel the computation.
+     */
+    virtual bool cancel();
+
+    /**
+     * @brief Gets the name of the contender that won the last race, or an empty string if none did.
+     */
+    std::string getWinner() const;
+
+    /**
+     * @brief Parses a race mode name, "first" or "best".
+     * @param mode_name Name of the mode
+     * @param mode The parsed mode
+     * @return true, if the name is a valid race mode
+     */
+    static bool parseRaceMode(const std::string &mode_name, RaceMode &mode);
+
+  private:
+
+    /**
+     * @brief Starts all the contenders and waits until the race is decided.
+     * @param start The start pose for planning
+     * @param goal The goal pose for planning
+     * @param tolerance The goal tolerance
+     * @param plan The plan of the winner, if any
+     * @param cost The cost of the winner's plan
+     * @param message The message of the winner, or of the last contender failing if there is no winner
+     * @return The outcome of the winner, or the outcome of the last contender failing if there is no winner
+     */
+    virtual uint32_t makePlan(
+        const geometry_msgs::PoseStamped &start,
+        const geometry_msgs::PoseStamped &goal,
+        double tolerance,
+        std::vector<geometry_msgs::PoseStamped> &plan,
+        double &cost,
+        std::string &message);
+
+    /**
+     * @brief Cancels all contenders still planning.
+     * @return true, if at least one of them accepted the cancel request.
+     */
+    bool cancelContenders();
+
+    /**
+     * @brief Condition variable notified by all the contenders when their state changes, and on cancel. It's shared
+     *        with the contenders' state callbacks, as losers can still be running after the race is destroyed.
+     */
+    struct StateUpdate
+    {
+      boost::mutex mutex;
+      boost::condition_variable condition;
+
+      void notify();
+    };
+
+    //! wakes up the race when any of the contenders changes its state
+    boost::shared_ptr<StateUpdate> state_update_;
+
+    //! planner executions taking part in the race
+    std::vector<AbstractPlannerExecution::Ptr> contenders_;
+
+    //! how the winner of the race is chosen
+    RaceMode mode_;
+
+    //! maximum time to wait for the contenders; zero for no deadline
+    ros::Duration deadline_;
+
+    //! mutex to handle safe thread communication for the winner
+    mutable boost::mutex winner_mtx_;
+
+    //! name of the contender that won the last race
+    std::string winner_;
+  };
+
+} /* namespace mbf_abstract_nav */
+
+#endif /* MBF_ABSTRACT_NAV__PLANNER_RACE_EXECUTION_H_ */
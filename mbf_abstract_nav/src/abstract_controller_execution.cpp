@@ -38,6 +38,10 @@
  *
  */
 
+#include <algorithm>
+
+#include <boost/make_shared.hpp>
+
 #include <mbf_msgs/ExePathResult.h>
 
 #include "mbf_abstract_nav/abstract_controller_execution.h"
@@ -46,10 +50,47 @@ namespace mbf_abstract_nav
 {
 
 const double AbstractControllerExecution::DEFAULT_CONTROLLER_FREQUENCY = 100.0; // 100 Hz
+const double AbstractControllerExecution::LATENCY_SMOOTHING = 0.2;
+const size_t AbstractControllerExecution::GOVERNOR_WINDOW = 20;
+
+void AbstractControllerExecution::Settings::loadParams(const ros::NodeHandle &private_nh)
+{
+  private_nh.param("robot_frame", robot_frame, std::string("base_link"));
+  private_nh.param("map_frame", global_frame, std::string("map"));
+  private_nh.param("force_stop_at_goal", force_stop_at_goal, false);
+  private_nh.param("force_stop_on_retry", force_stop_on_retry, true);
+  private_nh.param("force_stop_on_cancel", force_stop_on_cancel, false);
+  private_nh.param("mbf_tolerance_check", mbf_tolerance_check, false);
+  private_nh.param("dist_tolerance", dist_tolerance, 0.1);
+  private_nh.param("angle_tolerance", angle_tolerance, M_PI / 18.0);
+  private_nh.param("tf_timeout", tf_timeout, 1.0);
+  private_nh.param("cmd_vel_ignored_tolerance", cmd_vel_ignored_tolerance, 5.0);
+  private_nh.param("controller_latency_compensation", latency_compensation, false);
+  private_nh.param("cmd_vel_publish_frequency", cmd_vel_publish_frequency, 0.0);
+  private_nh.param("cmd_vel_interpolation", cmd_vel_interpolation, false);
+  private_nh.param("cmd_vel_republish_timeout", cmd_vel_republish_timeout, 0.5);
+}
+
+AbstractControllerExecution::Settings::ConstPtr AbstractControllerExecution::Settings::load(
+    const ros::NodeHandle &private_nh)
+{
+  boost::shared_ptr<Settings> settings = boost::make_shared<Settings>();
+  settings->loadParams(private_nh);
+  return settings;
+}
 
 AbstractControllerExecution::AbstractControllerExecution(
     const std::string& name, const mbf_abstract_core::AbstractController::Ptr& controller_ptr,
     const mbf_utility::RobotInformation& robot_info, const ros::Publisher& vel_pub, const MoveBaseFlexConfig& config)
+  : AbstractControllerExecution(name, controller_ptr, robot_info, vel_pub, Settings::load(ros::NodeHandle("~")),
+                                config)
+{
+}
+
+AbstractControllerExecution::AbstractControllerExecution(
+    const std::string& name, const mbf_abstract_core::AbstractController::Ptr& controller_ptr,
+    const mbf_utility::RobotInformation& robot_info, const ros::Publisher& vel_pub,
+    const Settings::ConstPtr& settings, const MoveBaseFlexConfig& config)
   : AbstractExecutionBase(name, robot_info)
   , controller_(controller_ptr)
   , state_(INITIALIZED)
@@ -58,20 +99,36 @@ AbstractControllerExecution::AbstractControllerExecution(
   , patience_(0)
   , vel_pub_(vel_pub)
   , loop_rate_(DEFAULT_CONTROLLER_FREQUENCY)
+  , max_frequency_(DEFAULT_CONTROLLER_FREQUENCY)
+  , min_frequency_(0.0)
+  , max_utilization_(1.0)
+  , frequency_(DEFAULT_CONTROLLER_FREQUENCY)
+  , compute_times_(GOVERNOR_WINDOW)
+  , cmd_vel_republishing_(false)
+  , preparing_plan_(false)
+  , plan_preparation_done_(false)
+  , plan_prepared_(false)
 {
-  ros::NodeHandle private_nh("~");
-
   // non-dynamically reconfigurable parameters
-  private_nh.param("robot_frame", robot_frame_, std::string("base_link"));
-  private_nh.param("map_frame", global_frame_, std::string("map"));
-  private_nh.param("force_stop_at_goal", force_stop_at_goal_, false);
-  private_nh.param("force_stop_on_retry", force_stop_on_retry_, true);
-  private_nh.param("force_stop_on_cancel", force_stop_on_cancel_, false);
-  private_nh.param("mbf_tolerance_check", mbf_tolerance_check_, false);
-  private_nh.param("dist_tolerance", dist_tolerance_, 0.1);
-  private_nh.param("angle_tolerance", angle_tolerance_, M_PI / 18.0);
-  private_nh.param("tf_timeout", tf_timeout_, 1.0);
-  private_nh.param("cmd_vel_ignored_tolerance", cmd_vel_ignored_tolerance_, 5.0);
+  robot_frame_ = settings->robot_frame;
+  global_frame_ = settings->global_frame;
+  force_stop_at_goal_ = settings->force_stop_at_goal;
+  force_stop_on_retry_ = settings->force_stop_on_retry;
+  force_stop_on_cancel_ = settings->force_stop_on_cancel;
+  mbf_tolerance_check_ = settings->mbf_tolerance_check;
+  dist_tolerance_ = settings->dist_tolerance;
+  angle_tolerance_ = settings->angle_tolerance;
+  tf_timeout_ = settings->tf_timeout;
+  cmd_vel_ignored_tolerance_ = settings->cmd_vel_ignored_tolerance;
+  latency_compensation_ = settings->latency_compensation;
+  cmd_vel_publish_frequency_ = settings->cmd_vel_publish_frequency;
+  cmd_vel_interpolation_ = settings->cmd_vel_interpolation;
+  cmd_vel_republish_timeout_ = settings->cmd_vel_republish_timeout;
+
+  health_.name = "controller_health";
+  health_.hardware_id = name;
+  health_.level = diagnostic_msgs::DiagnosticStatus::OK;
+  health_.message = "No compute time statistics yet";
 
   // dynamically reconfigurable parameters
   reconfigure(config);
@@ -100,7 +157,13 @@ void AbstractControllerExecution::reconfigure(const MoveBaseFlexConfig &config)
   // If it doesn't return within time, the navigator will cancel it and abort the corresponding action
   patience_ = ros::Duration(config.controller_patience);
 
-  setControllerFrequency(config.controller_frequency);
+  if (setControllerFrequency(config.controller_frequency))
+  {
+    max_frequency_ = frequency_ = config.controller_frequency;
+  }
+  min_frequency_ = config.controller_min_frequency;
+  max_utilization_ = config.controller_max_utilization;
+  compute_times_.clear();
 
   max_retries_ = config.controller_max_retries;
 }
@@ -118,6 +181,44 @@ bool AbstractControllerExecution::start()
 }
 
 
+void AbstractControllerExecution::reset()
+{
+  AbstractExecutionBase::reset();
+  setState(INITIALIZED);
+  moving_ = false;
+
+  {
+    boost::lock_guard<boost::mutex> guard(plan_mtx_);
+    new_plan_ = false;
+    plan_.clear();  // keeps the capacity, so the next plan is usually copied without reallocating
+    tolerance_from_action_ = false;
+  }
+
+  // nothing from the previous goal must leak into the next one: feedback, patience checks nor health
+  {
+    boost::lock_guard<boost::mutex> guard(vel_cmd_mtx_);
+    vel_cmd_stamped_ = geometry_msgs::TwistStamped();
+  }
+  {
+    boost::lock_guard<boost::mutex> guard(lct_mtx_);
+    last_call_time_ = ros::Time();
+    last_valid_cmd_time_ = ros::Time();
+  }
+  {
+    // the governor starts over from the configured rate; the execution thread is already joined
+    boost::lock_guard<boost::mutex> guard(configuration_mutex_);
+    compute_times_.clear();
+    if (frequency_ != max_frequency_ && setControllerFrequency(max_frequency_))
+    {
+      frequency_ = max_frequency_;
+    }
+    health_.level = diagnostic_msgs::DiagnosticStatus::OK;
+    health_.message = "No compute time statistics yet";
+    health_.values.clear();
+  }
+}
+
+
 void AbstractControllerExecution::setState(ControllerState state)
 {
   boost::lock_guard<boost::mutex> guard(state_mtx_);
@@ -193,7 +294,8 @@ bool AbstractControllerExecution::checkCmdVelIgnored(const geometry_msgs::Twist&
     return false;
   }
 
-  const bool robot_stopped = robot_info_.isRobotStopped(1e-3, 1e-3);
+  // the robot must be stopped on all the odometry received over the last cycles, so a single sample doesn't count
+  const bool robot_stopped = robot_info_.isRobotStopped(1e-3, 1e-3, ros::Duration(0.2));
 
   // compute linear and angular velocity magnitude
   const double cmd_linear = std::hypot(cmd_vel.linear.x, cmd_vel.linear.y);
@@ -268,6 +370,138 @@ bool AbstractControllerExecution::isMoving() const
   return moving_;
 }
 
+AbstractControllerExecution::LatencyCompensationStats AbstractControllerExecution::getLatencyCompensationStats() const
+{
+  boost::lock_guard<boost::mutex> guard(latency_stats_mtx_);
+  return latency_stats_;
+}
+
+diagnostic_msgs::DiagnosticStatus AbstractControllerExecution::getHealth() const
+{
+  boost::lock_guard<boost::mutex> guard(configuration_mutex_);
+  return health_;
+}
+
+void AbstractControllerExecution::governLoopRate(const ros::Duration &compute_time)
+{
+  boost::lock_guard<boost::mutex> guard(configuration_mutex_);
+  compute_times_.push_back(compute_time.toSec());
+  if (!compute_times_.full())
+  {
+    return;
+  }
+
+  // we use a high percentile instead of the mean, so occasional slow cycles also count
+  std::vector<double> samples(compute_times_.begin(), compute_times_.end());
+  std::vector<double>::iterator p90 = samples.begin() + samples.size() * 9 / 10;
+  std::nth_element(samples.begin(), p90, samples.end());
+  const double compute_p90 = *p90;
+  const double utilization = compute_p90 * frequency_;
+
+  double new_frequency = frequency_;
+  if (min_frequency_ > 0.0 && min_frequency_ < max_frequency_ && compute_p90 > 0.0)
+  {
+    const double sustainable_frequency = max_utilization_ / compute_p90;
+    if (sustainable_frequency < frequency_ * 0.95)
+    {
+      // lower the rate right away, so we stop missing deadlines
+      new_frequency = std::max(sustainable_frequency, min_frequency_);
+    }
+    else if (sustainable_frequency > frequency_ * 1.2)
+    {
+      // raise it back gradually, to avoid jittering around the limit
+      new_frequency = std::min(std::min(frequency_ * 1.1, sustainable_frequency), max_frequency_);
+    }
+  }
+
+  health_.values.resize(4);
+  health_.values[0].key = "frequency";
+  health_.values[0].value = std::to_string(new_frequency);
+  health_.values[1].key = "configured_frequency";
+  health_.values[1].value = std::to_string(max_frequency_);
+  health_.values[2].key = "compute_time_p90";
+  health_.values[2].value = std::to_string(compute_p90);
+  health_.values[3].key = "utilization";
+  health_.values[3].value = std::to_string(utilization);
+  if (utilization >= 1.0 && new_frequency == frequency_)
+  {
+    health_.level = diagnostic_msgs::DiagnosticStatus::ERROR;
+    health_.message = "Controller cannot keep up with the control loop rate";
+  }
+  else if (utilization > max_utilization_ || new_frequency < max_frequency_)
+  {
+    health_.level = diagnostic_msgs::DiagnosticStatus::WARN;
+    health_.message = "Control loop rate lowered to keep up with the controller";
+  }
+  else
+  {
+    health_.level = diagnostic_msgs::DiagnosticStatus::OK;
+    health_.message = "Controller keeps up with the control loop rate";
+  }
+
+  if (new_frequency != frequency_)
+  {
+    ROS_INFO_STREAM("Controller \"" << name_ << "\" compute time (90th percentile: " << compute_p90
+                    << "s) requires changing the control loop rate from " << frequency_ << " to "
+                    << new_frequency << " Hz");
+    frequency_ = new_frequency;
+    loop_rate_ = ros::Rate(frequency_);
+    compute_times_.clear();  // wait for a full window with the new rate before adapting it again
+  }
+}
+
+bool AbstractControllerExecution::predictCommandPose(const geometry_msgs::TwistStamped &robot_velocity,
+                                                     geometry_msgs::PoseStamped &predicted_pose) const
+{
+  boost::lock_guard<boost::mutex> guard(latency_stats_mtx_);
+  if (latency_stats_.compute_latency <= 0.0)
+  {
+    return false;  // no plugin call measured yet
+  }
+  mbf_utility::predictPose(robot_pose_, robot_velocity.twist, ros::Duration(latency_stats_.compute_latency),
+                           predicted_pose);
+  return true;
+}
+
+void AbstractControllerExecution::updateLatencyCompensation(const ros::Duration &compute_time,
+                                                            const geometry_msgs::PoseStamped *predicted_pose,
+                                                            const geometry_msgs::TwistStamped &robot_velocity)
+{
+  // compare the prediction with the robot pose now that the command is about to be published; as the latest pose
+  // can be older than that, we first move the prediction to the pose's stamp
+  geometry_msgs::PoseStamped current_pose, expected_pose;
+  const bool evaluate = predicted_pose && robot_info_.getRobotPose(current_pose);
+  if (evaluate)
+  {
+    mbf_utility::predictPose(*predicted_pose, robot_velocity.twist,
+                             current_pose.header.stamp - predicted_pose->header.stamp, expected_pose);
+  }
+
+  boost::lock_guard<boost::mutex> guard(latency_stats_mtx_);
+  if (latency_stats_.compute_latency <= 0.0)
+  {
+    latency_stats_.compute_latency = compute_time.toSec();
+  }
+  else
+  {
+    latency_stats_.compute_latency += LATENCY_SMOOTHING * (compute_time.toSec() - latency_stats_.compute_latency);
+  }
+
+  if (evaluate)
+  {
+    latency_stats_.last_dist_error = mbf_utility::distance(expected_pose, current_pose);
+    latency_stats_.last_angle_error = mbf_utility::angle(expected_pose, current_pose);
+    ++latency_stats_.samples;
+    latency_stats_.mean_dist_error +=
+        (latency_stats_.last_dist_error - latency_stats_.mean_dist_error) / latency_stats_.samples;
+    latency_stats_.mean_angle_error +=
+        (latency_stats_.last_angle_error - latency_stats_.mean_angle_error) / latency_stats_.samples;
+    ROS_DEBUG_STREAM_NAMED("abstract_controller_execution", "Latency compensation: compute latency "
+                           << latency_stats_.compute_latency << " s, prediction error "
+                           << latency_stats_.last_dist_error << " m, " << latency_stats_.last_angle_error << " rad");
+  }
+}
+
 bool AbstractControllerExecution::reachedGoalCheck()
 {
   //if action has a specific tolerance, check goal reached with those tolerances
@@ -310,9 +544,25 @@ bool AbstractControllerExecution::cancel()
 
 
 void AbstractControllerExecution::run()
+{
+  startCmdVelRepublisher();
+  controlLoop();
+  stopCmdVelRepublisher();
+  stopPlanPreparation();
+}
+
+void AbstractControllerExecution::controlLoop()
 {
   start_time_ = ros::Time::now();
 
+  {
+    // prediction errors refer to the current run, but we keep the computing time estimation
+    boost::lock_guard<boost::mutex> guard(latency_stats_mtx_);
+    const double compute_latency = latency_stats_.compute_latency;
+    latency_stats_ = LatencyCompensationStats();
+    latency_stats_.compute_latency = compute_latency;
+  }
+
   // init plan
   std::vector<geometry_msgs::PoseStamped> plan;
   if (!hasNewPlan())
@@ -352,9 +602,23 @@ void AbstractControllerExecution::run()
         continue;
       }
 
-      // update plan dynamically
-      if (hasNewPlan())
+      // commit the plan prepared on the side thread, once ready; plans are only swapped here, at a cycle boundary
+      bool plan_prepared;
+      if (takePlanPreparationResult(plan_prepared))
+      {
+        if (!plan_prepared || !controller_->commitPreparedPlan())
+        {
+          setState(INVALID_PLAN);
+          moving_ = false;
+          condition_.notify_all();
+          return;
+        }
+      }
+
+      // update plan dynamically; if a plan is being prepared, the new one waits until it's committed
+      if (!isPreparingPlan() && hasNewPlan())
       {
+        const bool following_plan = !plan.empty();
         plan = getNewPlan();
 
         // check if plan is empty
@@ -366,8 +630,13 @@ void AbstractControllerExecution::run()
           return;
         }
 
+        if (following_plan && controller_->supportsPlanPreparation())
+        {
+          // keep following the current plan while the controller prepares the new one
+          startPlanPreparation(plan);
+        }
         // check if plan could be set
-        if (!controller_->setPlan(plan))
+        else if (!controller_->setPlan(plan))
         {
           setState(INVALID_PLAN);
           moving_ = false;
@@ -407,20 +676,36 @@ void AbstractControllerExecution::run()
         setState(PLANNING);
 
         // save time and call the plugin
+        const ros::Time call_time = ros::Time::now();
         lct_mtx_.lock();
-        last_call_time_ = ros::Time::now();
+        last_call_time_ = call_time;
         lct_mtx_.unlock();
 
-        // call plugin to compute the next velocity command
         geometry_msgs::TwistStamped cmd_vel_stamped;
+        // use the velocity at the time of the robot pose, so both are consistent; if it's not on the odometry
+        // history (e.g. the pose is older), fall back to the latest one
         geometry_msgs::TwistStamped robot_velocity;
-        robot_info_.getRobotVelocity(robot_velocity);
-        outcome_ = computeVelocityCmd(robot_pose_, robot_velocity, cmd_vel_stamped, message_ = "");
+        if (!robot_info_.getRobotVelocity(robot_pose_.header.stamp, robot_velocity))
+        {
+          robot_info_.getRobotVelocity(robot_velocity);
+        }
+
+        // with latency compensation, the plugin gets the pose the robot will have when the command is published,
+        // instead of the one it had when the cycle started, so the command is not already stale when applied
+        geometry_msgs::PoseStamped predicted_pose;
+        const bool predicted = latency_compensation_ && predictCommandPose(robot_velocity, predicted_pose);
+
+        // call plugin to compute the next velocity command
+        outcome_ = computeVelocityCmd(predicted ? predicted_pose : robot_pose_, robot_velocity, cmd_vel_stamped,
+                                      message_ = "");
+        const ros::Duration compute_time = ros::Time::now() - call_time;
+        updateLatencyCompensation(compute_time, predicted ? &predicted_pose : nullptr, robot_velocity);
+        governLoopRate(compute_time);
 
         if (outcome_ < 10)
         {
           setState(GOT_LOCAL_CMD);
-          vel_pub_.publish(cmd_vel_stamped.twist);
+          publishVelocityCmd(cmd_vel_stamped.twist);
           last_valid_cmd_time_ = ros::Time::now();
           retries = 0;
           // check if robot is ignoring velocity command
@@ -466,7 +751,7 @@ void AbstractControllerExecution::run()
           {
             // we are retrying compute velocity commands; we keep sending the command calculated by the plugin
             // with the expectation that it's a sensible one (e.g. slow down while respecting acceleration limits)
-            vel_pub_.publish(cmd_vel_stamped.twist);
+            publishVelocityCmd(cmd_vel_stamped.twist);
           }
         }
 
@@ -519,7 +804,157 @@ void AbstractControllerExecution::publishZeroVelocity()
   cmd_vel.angular.x = 0;
   cmd_vel.angular.y = 0;
   cmd_vel.angular.z = 0;
-  vel_pub_.publish(cmd_vel);
+  publishVelocityCmd(cmd_vel);
+}
+
+void AbstractControllerExecution::startPlanPreparation(const std::vector<geometry_msgs::PoseStamped> &plan)
+{
+  boost::lock_guard<boost::mutex> guard(plan_preparation_mtx_);
+  preparing_plan_ = true;
+  plan_preparation_done_ = false;
+  plan_preparation_thread_ = boost::thread(&AbstractControllerExecution::planPreparationThread, this, plan);
+}
+
+bool AbstractControllerExecution::takePlanPreparationResult(bool &prepared)
+{
+  {
+    boost::lock_guard<boost::mutex> guard(plan_preparation_mtx_);
+    if (!plan_preparation_done_)
+    {
+      return false;
+    }
+    prepared = plan_prepared_;
+    plan_preparation_done_ = false;
+    preparing_plan_ = false;
+  }
+  plan_preparation_thread_.join();  // it has already finished, so this returns immediately
+  return true;
+}
+
+bool AbstractControllerExecution::isPreparingPlan() const
+{
+  boost::lock_guard<boost::mutex> guard(plan_preparation_mtx_);
+  return preparing_plan_;
+}
+
+void AbstractControllerExecution::stopPlanPreparation()
+{
+  if (plan_preparation_thread_.joinable())
+  {
+    // the plugin cannot be interrupted while preparing a plan, so we must wait for it
+    boost::this_thread::disable_interruption no_interruption;
+    plan_preparation_thread_.join();
+  }
+  boost::lock_guard<boost::mutex> guard(plan_preparation_mtx_);
+  preparing_plan_ = false;
+  plan_preparation_done_ = false;
+}
+
+void AbstractControllerExecution::planPreparationThread(std::vector<geometry_msgs::PoseStamped> plan)
+{
+  bool prepared = false;
+  try
+  {
+    prepared = controller_->preparePlan(plan);
+  }
+  catch (...)
+  {
+    ROS_ERROR_STREAM("Controller plugin \"" << name_ << "\" failed to prepare the plan: "
+                     << boost::current_exception_diagnostic_information());
+  }
+
+  boost::lock_guard<boost::mutex> guard(plan_preparation_mtx_);
+  plan_prepared_ = prepared;
+  plan_preparation_done_ = true;
+}
+
+void AbstractControllerExecution::publishVelocityCmd(const geometry_msgs::Twist &cmd_vel)
+{
+  if (cmd_vel_publish_frequency_ <= 0.0)
+  {
+    vel_pub_.publish(cmd_vel);
+    return;
+  }
+
+  const bool stop = cmd_vel.linear.x == 0.0 && cmd_vel.linear.y == 0.0 && cmd_vel.angular.z == 0.0;
+
+  boost::lock_guard<boost::mutex> guard(cmd_vel_out_mtx_);
+  cmd_vel_from_ = cmd_vel_out_;
+  cmd_vel_target_ = cmd_vel;
+  cmd_vel_target_time_ = ros::Time::now();
+  cmd_vel_ramp_time_ = loop_rate_.expectedCycleTime();
+  if (!cmd_vel_interpolation_ || stop)
+  {
+    // publish right away; the republisher will repeat it until a new one arrives
+    cmd_vel_from_ = cmd_vel;
+    cmd_vel_out_ = cmd_vel;
+    vel_pub_.publish(cmd_vel_out_);
+  }
+}
+
+void AbstractControllerExecution::startCmdVelRepublisher()
+{
+  if (cmd_vel_publish_frequency_ <= 0.0)
+  {
+    return;
+  }
+
+  boost::lock_guard<boost::mutex> guard(cmd_vel_out_mtx_);
+  cmd_vel_target_time_ = ros::Time();
+  cmd_vel_out_ = geometry_msgs::Twist();
+  cmd_vel_republishing_ = true;
+  cmd_vel_thread_ = boost::thread(&AbstractControllerExecution::cmdVelRepublisherThread, this);
+}
+
+void AbstractControllerExecution::stopCmdVelRepublisher()
+{
+  if (!cmd_vel_thread_.joinable())
+  {
+    return;
+  }
+
+  cmd_vel_out_mtx_.lock();
+  cmd_vel_republishing_ = false;
+  cmd_vel_out_cv_.notify_all();
+  cmd_vel_out_mtx_.unlock();
+
+  // the republisher stops immediately; don't let an interruption of our thread leave it running
+  boost::this_thread::disable_interruption no_interruption;
+  cmd_vel_thread_.join();
+}
+
+void AbstractControllerExecution::cmdVelRepublisherThread()
+{
+  const boost::chrono::microseconds period(static_cast<int64_t>(1e6 / cmd_vel_publish_frequency_));
+
+  boost::unique_lock<boost::mutex> lock(cmd_vel_out_mtx_);
+  while (cmd_vel_republishing_)
+  {
+    const ros::Time now = ros::Time::now();
+    if (!cmd_vel_target_time_.isZero() && (now - cmd_vel_target_time_).toSec() <= cmd_vel_republish_timeout_)
+    {
+      if (cmd_vel_interpolation_ && cmd_vel_ramp_time_ > ros::Duration(0))
+      {
+        const double ratio = std::min((now - cmd_vel_target_time_).toSec() / cmd_vel_ramp_time_.toSec(), 1.0);
+        cmd_vel_out_ = cmd_vel_target_;
+        cmd_vel_out_.linear.x = cmd_vel_from_.linear.x + ratio * (cmd_vel_target_.linear.x - cmd_vel_from_.linear.x);
+        cmd_vel_out_.linear.y = cmd_vel_from_.linear.y + ratio * (cmd_vel_target_.linear.y - cmd_vel_from_.linear.y);
+        cmd_vel_out_.angular.z =
+            cmd_vel_from_.angular.z + ratio * (cmd_vel_target_.angular.z - cmd_vel_from_.angular.z);
+      }
+      else
+      {
+        cmd_vel_out_ = cmd_vel_target_;
+      }
+      vel_pub_.publish(cmd_vel_out_);
+    }
+    else if (!cmd_vel_target_time_.isZero())
+    {
+      ROS_WARN_THROTTLE(1.0, "No new velocity command for %.2fs; stop republishing the last one",
+                        (now - cmd_vel_target_time_).toSec());
+    }
+    cmd_vel_out_cv_.wait_for(lock, period);
+  }
 }
 
 } /* namespace mbf_abstract_nav */
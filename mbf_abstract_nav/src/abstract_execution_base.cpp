@@ -80,6 +80,19 @@ void AbstractExecutionBase::join()
     thread_.join();
 }
 
+bool AbstractExecutionBase::tryJoin()
+{
+  return !thread_.joinable() || thread_.try_join_for(boost::chrono::milliseconds(0));
+}
+
+void AbstractExecutionBase::reset()
+{
+  join();
+  cancel_ = false;
+  outcome_ = 255;
+  message_.clear();
+}
+
 boost::cv_status AbstractExecutionBase::waitForStateUpdate(boost::chrono::microseconds const& duration)
 {
   boost::mutex mutex;
@@ -39,6 +39,7 @@
  */
 
 #include <nav_msgs/Path.h>
+#include <XmlRpcException.h>
 
 #include "mbf_abstract_nav/abstract_navigation_server.h"
 
@@ -61,10 +62,22 @@ AbstractNavigationServer::AbstractNavigationServer(const TFPtr &tf_listener_ptr)
       robot_frame_(private_nh_.param<std::string>("robot_frame", "base_link")),
       robot_info_(*tf_listener_ptr, global_frame_, robot_frame_, tf_timeout_,
                   private_nh_.param<std::string>("odom_topic", "odom")),
+      intra_process_move_base_(private_nh_.param("intra_process_move_base", false)),
+      planner_settings_(AbstractPlannerExecution::Settings::load(private_nh_)),
+      controller_settings_(AbstractControllerExecution::Settings::load(private_nh_)),
       controller_action_(name_action_exe_path, robot_info_),
       planner_action_(name_action_get_path, robot_info_),
       recovery_action_(name_action_recovery, robot_info_),
-      move_base_action_(name_action_move_base, robot_info_, recovery_plugin_manager_.getLoadedNames())
+      move_base_action_(name_action_move_base, robot_info_, recovery_plugin_manager_.getLoadedNames(),
+                        newMoveBaseActionClient<mbf_msgs::GetPathAction>(
+                            name_action_get_path, &AbstractNavigationServer::callActionGetPath,
+                            &AbstractNavigationServer::cancelActionGetPath),
+                        newMoveBaseActionClient<mbf_msgs::ExePathAction>(
+                            name_action_exe_path, &AbstractNavigationServer::callActionExePath,
+                            &AbstractNavigationServer::cancelActionExePath),
+                        newMoveBaseActionClient<mbf_msgs::RecoveryAction>(
+                            name_action_recovery, &AbstractNavigationServer::callActionRecovery,
+                            &AbstractNavigationServer::cancelActionRecovery))
 {
   // init cmd_vel publisher for the robot velocity
   vel_pub_ = ros::NodeHandle().advertise<geometry_msgs::Twist>("cmd_vel", 1);
@@ -111,6 +124,75 @@ void AbstractNavigationServer::initializeServerComponents()
   planner_plugin_manager_.loadPlugins();
   controller_plugin_manager_.loadPlugins();
   recovery_plugin_manager_.loadPlugins();
+  loadPlannerRaces();
+}
+
+bool AbstractNavigationServer::loadPlannerRaces()
+{
+  XmlRpc::XmlRpcValue race_param_list;
+  if (!private_nh_.getParam("planner_races", race_param_list))
+  {
+    // planner races are optional
+    return true;
+  }
+
+  try
+  {
+    for (int i = 0; i < race_param_list.size(); i++)
+    {
+      XmlRpc::XmlRpcValue elem = race_param_list[i];
+
+      std::string name = elem["name"];
+      if (planner_races_.find(name) != planner_races_.end() || planner_plugin_manager_.hasPlugin(name))
+      {
+        ROS_ERROR_STREAM("The planner race \"" << name << "\" has the name of another race or planner! "
+                         << "Names must be unique!");
+        return false;
+      }
+
+      PlannerRace race;
+      XmlRpc::XmlRpcValue planners = elem["planners"];
+      for (int j = 0; j < planners.size(); j++)
+      {
+        std::string planner = planners[j];
+        if (!planner_plugin_manager_.hasPlugin(planner))
+        {
+          ROS_ERROR_STREAM("The planner \"" << planner << "\" of the race \"" << name << "\" is not loaded!");
+          return false;
+        }
+        race.planners.push_back(planner);
+      }
+
+      std::string mode = elem.hasMember("mode") ? static_cast<std::string>(elem["mode"]) : std::string("first");
+      if (!PlannerRaceExecution::parseRaceMode(mode, race.mode))
+      {
+        ROS_ERROR_STREAM("Invalid mode \"" << mode << "\" for the planner race \"" << name << "\"! "
+                         << "Use \"first\" or \"best\"");
+        return false;
+      }
+
+      double deadline = 0.0;
+      if (elem.hasMember("deadline"))
+      {
+        XmlRpc::XmlRpcValue &deadline_param = elem["deadline"];
+        deadline = deadline_param.getType() == XmlRpc::XmlRpcValue::TypeInt ?
+                   static_cast<int>(deadline_param) : static_cast<double>(deadline_param);
+      }
+      race.deadline = ros::Duration(deadline);
+
+      planner_races_.insert(std::pair<std::string, PlannerRace>(name, race));
+      ROS_INFO_STREAM("The planner race \"" << name << "\" with " << race.planners.size() << " planners, mode \""
+                      << mode << "\" and deadline " << deadline << "s has been loaded successfully.");
+    }
+  }
+  catch (XmlRpc::XmlRpcException &e)
+  {
+    ROS_ERROR_STREAM("Invalid parameter structure. The \"planner_races\" parameter has to be a list of structs "
+                     << "with fields \"name\", \"planners\" and optionally \"mode\" and \"deadline\"!");
+    ROS_ERROR_STREAM(e.getMessage());
+    return false;
+  }
+  return true;
 }
 
 AbstractNavigationServer::~AbstractNavigationServer()
@@ -123,6 +205,26 @@ void AbstractNavigationServer::callActionGetPath(ActionServerGetPath::GoalHandle
   const mbf_msgs::GetPathGoal &goal = *(goal_handle.getGoal().get());
   const geometry_msgs::Point &p = goal.target_pose.pose.position;
 
+  if (planner_races_.find(goal.planner) != planner_races_.end())
+  {
+    ROS_DEBUG_STREAM_NAMED("get_path", "Start action \"get_path\" using planner race \"" << goal.planner << "\"");
+
+    mbf_abstract_nav::AbstractPlannerExecution::Ptr race_execution = newPlannerRaceExecution(goal.planner);
+    if (race_execution)
+    {
+      planner_action_.start(goal_handle, race_execution);
+    }
+    else
+    {
+      mbf_msgs::GetPathResult result;
+      result.outcome = mbf_msgs::GetPathResult::INTERNAL_ERROR;
+      result.message = "Internal Error: could not create the planner race \"" + goal.planner + "\"!";
+      ROS_FATAL_STREAM_NAMED("get_path", result.message);
+      goal_handle.setRejected(result, result.message);
+    }
+    return;
+  }
+
   std::string planner_name;
   if(!planner_plugin_manager_.getLoadedNames().empty())
   {
@@ -155,8 +257,9 @@ void AbstractNavigationServer::callActionGetPath(ActionServerGetPath::GoalHandle
 
   if(planner_plugin)
   {
-    mbf_abstract_nav::AbstractPlannerExecution::Ptr planner_execution
-        = newPlannerExecution(planner_name, planner_plugin);
+    mbf_abstract_nav::AbstractPlannerExecution::Ptr planner_execution = planner_execution_pool_.acquire(
+        planner_name, boost::bind(&AbstractNavigationServer::newPlannerExecution, this, planner_name, planner_plugin),
+        last_config_);
 
     //start another planning action
     planner_action_.start(goal_handle, planner_execution);
@@ -213,8 +316,10 @@ void AbstractNavigationServer::callActionExePath(ActionServerExePath::GoalHandle
 
   if(controller_plugin)
   {
-    mbf_abstract_nav::AbstractControllerExecution::Ptr controller_execution
-        = newControllerExecution(controller_name, controller_plugin);
+    mbf_abstract_nav::AbstractControllerExecution::Ptr controller_execution = controller_execution_pool_.acquire(
+        controller_name,
+        boost::bind(&AbstractNavigationServer::newControllerExecution, this, controller_name, controller_plugin),
+        last_config_);
 
     // starts another controller action
     controller_action_.start(goal_handle, controller_execution);
@@ -272,8 +377,10 @@ void AbstractNavigationServer::callActionRecovery(ActionServerRecovery::GoalHand
 
   if(recovery_plugin)
   {
-    mbf_abstract_nav::AbstractRecoveryExecution::Ptr recovery_execution
-        = newRecoveryExecution(recovery_name, recovery_plugin);
+    mbf_abstract_nav::AbstractRecoveryExecution::Ptr recovery_execution = recovery_execution_pool_.acquire(
+        recovery_name,
+        boost::bind(&AbstractNavigationServer::newRecoveryExecution, this, recovery_name, recovery_plugin),
+        last_config_);
 
     recovery_action_.start(goal_handle, recovery_execution);
   }
@@ -310,8 +417,36 @@ mbf_abstract_nav::AbstractPlannerExecution::Ptr AbstractNavigationServer::newPla
     const std::string &plugin_name,
     const mbf_abstract_core::AbstractPlanner::Ptr &plugin_ptr)
 {
-  return boost::make_shared<mbf_abstract_nav::AbstractPlannerExecution>(plugin_name, plugin_ptr,
-                                                                        robot_info_, last_config_);
+  return boost::make_shared<mbf_abstract_nav::AbstractPlannerExecution>(plugin_name, plugin_ptr, robot_info_,
+                                                                        planner_settings_, last_config_);
+}
+
+mbf_abstract_nav::AbstractPlannerExecution::Ptr AbstractNavigationServer::newPlannerRaceExecution(
+    const std::string &race_name)
+{
+  std::map<std::string, PlannerRace>::const_iterator race_it = planner_races_.find(race_name);
+  if (race_it == planner_races_.end())
+  {
+    return mbf_abstract_nav::AbstractPlannerExecution::Ptr();
+  }
+
+  // every contender gets its own execution, so they can plan in parallel
+  const PlannerRace &race = race_it->second;
+  std::vector<mbf_abstract_nav::AbstractPlannerExecution::Ptr> contenders;
+  std::vector<std::string>::const_iterator it;
+  for (it = race.planners.begin(); it != race.planners.end(); ++it)
+  {
+    mbf_abstract_core::AbstractPlanner::Ptr planner_plugin = planner_plugin_manager_.getPlugin(*it);
+    if (!planner_plugin)
+    {
+      return mbf_abstract_nav::AbstractPlannerExecution::Ptr();
+    }
+    contenders.push_back(planner_execution_pool_.acquire(
+        *it, boost::bind(&AbstractNavigationServer::newPlannerExecution, this, *it, planner_plugin), last_config_));
+  }
+
+  return boost::make_shared<mbf_abstract_nav::PlannerRaceExecution>(race_name, contenders, race.mode, race.deadline,
+                                                                    robot_info_, planner_settings_, last_config_);
 }
 
 mbf_abstract_nav::AbstractControllerExecution::Ptr AbstractNavigationServer::newControllerExecution(
@@ -319,7 +454,8 @@ mbf_abstract_nav::AbstractControllerExecution::Ptr AbstractNavigationServer::new
     const mbf_abstract_core::AbstractController::Ptr &plugin_ptr)
 {
   return boost::make_shared<mbf_abstract_nav::AbstractControllerExecution>(plugin_name, plugin_ptr, robot_info_,
-                                                                           vel_pub_, last_config_);
+                                                                           vel_pub_, controller_settings_,
+                                                                           last_config_);
 }
 
 mbf_abstract_nav::AbstractRecoveryExecution::Ptr AbstractNavigationServer::newRecoveryExecution(
@@ -38,14 +38,39 @@
  *
  */
 
+#include <boost/make_shared.hpp>
+
 #include "mbf_abstract_nav/abstract_planner_execution.h"
 
 namespace mbf_abstract_nav
 {
 
+void AbstractPlannerExecution::Settings::loadParams(const ros::NodeHandle &private_nh)
+{
+  private_nh.param("robot_frame", robot_frame, std::string("base_footprint"));
+  private_nh.param("map_frame", global_frame, std::string("map"));
+}
+
+AbstractPlannerExecution::Settings::ConstPtr AbstractPlannerExecution::Settings::load(
+    const ros::NodeHandle &private_nh)
+{
+  boost::shared_ptr<Settings> settings = boost::make_shared<Settings>();
+  settings->loadParams(private_nh);
+  return settings;
+}
+
+AbstractPlannerExecution::AbstractPlannerExecution(const std::string& name,
+                                                   const mbf_abstract_core::AbstractPlanner::Ptr& planner_ptr,
+                                                   const mbf_utility::RobotInformation &robot_info,
+                                                   const MoveBaseFlexConfig& config)
+  : AbstractPlannerExecution(name, planner_ptr, robot_info, Settings::load(ros::NodeHandle("~")), config)
+{
+}
+
 AbstractPlannerExecution::AbstractPlannerExecution(const std::string& name,
                                                    const mbf_abstract_core::AbstractPlanner::Ptr& planner_ptr,
                                                    const mbf_utility::RobotInformation &robot_info,
+                                                   const Settings::ConstPtr& settings,
                                                    const MoveBaseFlexConfig& config)
   : AbstractExecutionBase(name, robot_info)
   , planner_(planner_ptr)
@@ -55,11 +80,9 @@ AbstractPlannerExecution::AbstractPlannerExecution(const std::string& name,
   , has_new_start_(false)
   , has_new_goal_(false)
 {
-  ros::NodeHandle private_nh("~");
-
   // non-dynamically reconfigurable parameters
-  private_nh.param("robot_frame", robot_frame_, std::string("base_footprint"));
-  private_nh.param("map_frame", global_frame_, std::string("map"));
+  robot_frame_ = settings->robot_frame;
+  global_frame_ = settings->global_frame;
 
   // dynamically reconfigurable parameters
   reconfigure(config);
@@ -69,24 +92,6 @@ AbstractPlannerExecution::~AbstractPlannerExecution()
 {
 }
 
-template <typename _Iter>
-double sumDistance(_Iter _begin, _Iter _end)
-{
-  // helper function to get the distance of a path.
-  // in C++11, we could add static_assert on the interator_type.
-  double dist = 0.;
-
-  // minimum length of the path is 2.
-  if (std::distance(_begin, _end) < 2)
-    return dist;
-
-  // two pointer iteration
-  for (_Iter next = _begin + 1; next != _end; ++_begin, ++next)
-    dist += mbf_utility::distance(*_begin, *next);
-
-  return dist;
-}
-
 double AbstractPlannerExecution::getCost() const
 {
   return cost_;
@@ -119,17 +124,33 @@ typename AbstractPlannerExecution::PlanningState AbstractPlannerExecution::getSt
   return state_;
 }
 
-void AbstractPlannerExecution::setState(PlanningState state, bool signalling)
+void AbstractPlannerExecution::setStateCallback(const boost::function<void()> &callback)
 {
   boost::lock_guard<boost::mutex> guard(state_mtx_);
-  state_ = state;
+  state_callback_ = callback;
+}
+
+void AbstractPlannerExecution::setState(PlanningState state, bool signalling)
+{
+  boost::function<void()> callback;
+  {
+    boost::lock_guard<boost::mutex> guard(state_mtx_);
+    state_ = state;
+
+    // we exit planning if we are signalling.
+    planning_ = !signalling;
 
-  // we exit planning if we are signalling.
-  planning_ = !signalling;
+    // some states are quiet, most aren't
+    if (!signalling)
+      return;
 
-  // some states are quiet, most aren't
-  if(signalling)
     condition_.notify_all();
+    callback = state_callback_;
+  }
+
+  // called unlocked, as the callback can check our state
+  if (callback)
+    callback();
 }
 
 
@@ -194,10 +215,14 @@ bool AbstractPlannerExecution::start(const geometry_msgs::PoseStamped &start,
   }
   boost::lock_guard<boost::mutex> guard(planning_mtx_);
   planning_ = true;
+  cancel_ = false;  // a previous run could have been canceled, e.g. if it lost a planner race
   start_ = start;
   goal_ = goal;
   tolerance_ = tolerance;
 
+  // leave the state of the previous run, so whoever is watching us doesn't take it as the result of this one
+  setState(STARTED, false);
+
   const geometry_msgs::Point& s = start.pose.position;
   const geometry_msgs::Point& g = goal.pose.position;
 
@@ -223,6 +248,24 @@ bool AbstractPlannerExecution::cancel()
   return true;
 }
 
+void AbstractPlannerExecution::reset()
+{
+  AbstractExecutionBase::reset();
+  setState(INITIALIZED, false);
+  setStateCallback(boost::function<void()>());
+  planning_ = false;
+
+  {
+    boost::lock_guard<boost::mutex> guard(goal_start_mtx_);
+    has_new_start_ = false;
+    has_new_goal_ = false;
+  }
+
+  boost::lock_guard<boost::mutex> guard(plan_mtx_);
+  plan_.clear();  // keeps the capacity, so the next plan is usually copied without reallocating
+  cost_ = 0.0;
+}
+
 uint32_t AbstractPlannerExecution::makePlan(const geometry_msgs::PoseStamped &start,
                                             const geometry_msgs::PoseStamped &goal,
                                             double tolerance,
@@ -304,7 +347,7 @@ void AbstractPlannerExecution::run()
           cost_ = cost;
           // estimate the cost based on the distance if its zero.
           if (cost_ == 0)
-            cost_ = sumDistance(plan_.begin(), plan_.end());
+            cost_ = mbf_utility::pathLength(plan_.begin(), plan_.end());
 
           last_valid_plan_time_ = ros::Time::now();
           setState(FOUND_PLAN, true);
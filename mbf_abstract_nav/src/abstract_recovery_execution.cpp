@@ -100,6 +100,12 @@ bool AbstractRecoveryExecution::cancel()
   return true;
 }
 
+void AbstractRecoveryExecution::reset()
+{
+  AbstractExecutionBase::reset();
+  setState(INITIALIZED);
+}
+
 bool AbstractRecoveryExecution::isPatienceExceeded()
 {
   boost::lock_guard<boost::mutex> guard1(conf_mtx_);
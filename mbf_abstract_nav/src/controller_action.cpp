@@ -38,6 +38,8 @@
  *
  */
 
+#include <limits>
+
 #include "mbf_abstract_nav/controller_action.h"
 
 namespace mbf_abstract_nav
@@ -51,15 +53,22 @@ ControllerAction::ControllerAction(
   // informative topics: current navigation goal
   ros::NodeHandle private_nh("~");
   goal_pub_ = private_nh.advertise<geometry_msgs::PoseStamped>("controller_goal", 1);
+  health_pub_ = private_nh.advertise<diagnostic_msgs::DiagnosticStatus>("controller_health", 1);
+  compact_feedback_pub_ = private_nh.advertise<mbf_msgs::CompactFeedback>(action_name + "/compact_feedback", 10);
 }
 
 void ControllerAction::reconfigure(mbf_abstract_nav::MoveBaseFlexConfig& config, uint32_t level)
 {
   AbstractActionBase::reconfigure(config, level);
 
+  // running goals take a copy of these parameters when they start
+  boost::lock_guard<boost::mutex> guard(goal_mtx_);
   oscillation_timeout_ = ros::Duration(config.oscillation_timeout);
   oscillation_distance_ = config.oscillation_distance;
   oscillation_angle_ = config.oscillation_angle;
+  oscillation_min_path_efficiency_ = config.oscillation_min_path_efficiency;
+  feedback_period_ = ros::Duration(config.controller_feedback_frequency > 0.0 ?
+                                   1.0 / config.controller_feedback_frequency : 0.0);
 }
 
 void ControllerAction::start(
@@ -73,25 +82,27 @@ void ControllerAction::start(
     return;
   }
 
-  uint8_t slot = goal_handle.getGoal()->concurrency_slot;
+  uint8_t slot_id = goal_handle.getGoal()->concurrency_slot;
+  ConcurrencySlot &slot = concurrency_slots_[slot_id];
 
   bool update_plan = false;
-  slot_map_mtx_.lock();
-  std::map<uint8_t, ConcurrencySlot>::iterator slot_it = concurrency_slots_.find(slot);
-  if(slot_it != concurrency_slots_.end() && slot_it->second.in_use)
+  slot.mtx.lock();
+  if(slot.in_use && !slot.has_pending)
   {
+    // note that if there's a goal queued on the slot, the running execution is being canceled, so we cannot
+    // update its plan; the base class will replace the queued goal with the new one
     boost::lock_guard<boost::mutex> goal_guard(goal_mtx_);
-    const auto slot_status = slot_it->second.goal_handle.getGoalStatus().status;
-    if ((slot_it->second.execution->getName() == goal_handle.getGoal()->controller ||
+    const auto slot_status = slot.goal_handle.getGoalStatus().status;
+    if ((slot.execution->getName() == goal_handle.getGoal()->controller ||
          goal_handle.getGoal()->controller.empty()) &&
         (slot_status == actionlib_msgs::GoalStatus::ACTIVE || slot_status == actionlib_msgs::GoalStatus::PREEMPTING))
     {
-      ROS_DEBUG_STREAM_NAMED(name_, "Updating running controller goal of slot " << static_cast<int>(slot));
+      ROS_DEBUG_STREAM_NAMED(name_, "Updating running controller goal of slot " << static_cast<int>(slot_id));
       update_plan = true;
       // Goal requests to run the same controller on the same concurrency slot already in use:
       // we update the goal handle and pass the new plan and tolerances from the action to the
       // execution without stopping it
-      execution_ptr = slot_it->second.execution;
+      execution_ptr = slot.execution;
       execution_ptr->setNewPlan(goal_handle.getGoal()->path.poses,
                                 goal_handle.getGoal()->tolerance_from_action,
                                 goal_handle.getGoal()->dist_tolerance,
@@ -101,12 +112,12 @@ void ControllerAction::start(
       goal_pub_.publish(goal_pose_);
       mbf_msgs::ExePathResult result;
       fillExePathResult(mbf_msgs::ExePathResult::CANCELED, "Goal preempted by a new plan", result);
-      concurrency_slots_[slot].goal_handle.setCanceled(result, result.message);
-      concurrency_slots_[slot].goal_handle = goal_handle;
-      concurrency_slots_[slot].goal_handle.setAccepted();
+      slot.goal_handle.setCanceled(result, result.message);
+      slot.goal_handle = goal_handle;
+      slot.goal_handle.setAccepted();
     }
   }
-  slot_map_mtx_.unlock();
+  slot.mtx.unlock();
   if(!update_plan)
   {
     // Otherwise run parent version of this method
@@ -117,7 +128,7 @@ void ControllerAction::start(
 void ControllerAction::runImpl(GoalHandle &goal_handle, AbstractControllerExecution &execution)
 {
   goal_mtx_.lock();
-  // Note that we always use the goal handle stored on the concurrency slots map, as it can change when replanning
+  // Note that we always use the goal handle stored on the concurrency slots table, as it can change when replanning
   uint8_t slot = goal_handle.getGoal()->concurrency_slot;
   goal_mtx_.unlock();
 
@@ -127,8 +138,6 @@ void ControllerAction::runImpl(GoalHandle &goal_handle, AbstractControllerExecut
   goal_pose_ = geometry_msgs::PoseStamped();
   robot_pose_ = geometry_msgs::PoseStamped();
 
-  ros::NodeHandle private_nh("~");
-
   mbf_msgs::ExePathResult result;
   mbf_msgs::ExePathFeedback feedback;
 
@@ -151,6 +160,16 @@ void ControllerAction::runImpl(GoalHandle &goal_handle, AbstractControllerExecut
 
   goal_pose_ = plan.back();
   goal_pub_.publish(goal_pose_);
+
+  // the plan can be replaced while running by a new goal on the same slot; we track which one we are following
+  FeedbackState feedback_state;
+  feedback_state.path_tracker.setPath(plan);
+  feedback_state.period = feedback_period_;
+  std::string tracked_goal_id = goal_handle.getGoalID().id;
+
+  mbf_utility::OscillationDetector oscillation_detector(oscillation_timeout_, oscillation_distance_, oscillation_angle_,
+                                                        oscillation_min_path_efficiency_);
+
   ROS_DEBUG_STREAM_NAMED(name_, "Called action \""
       << name_ << "\" with plan:" << std::endl
       << "frame: \"" << goal.path.header.frame_id << "\" " << std::endl
@@ -162,11 +181,8 @@ void ControllerAction::runImpl(GoalHandle &goal_handle, AbstractControllerExecut
 
   goal_mtx_.unlock();
 
-
-  geometry_msgs::PoseStamped oscillation_pose;
-  ros::Time last_oscillation_reset = ros::Time::now();
-
-  bool first_cycle = true;
+  ros::Time last_health_time;
+  int last_health_level = -1;
 
   while (controller_active && ros::ok())
   {
@@ -183,13 +199,13 @@ void ControllerAction::runImpl(GoalHandle &goal_handle, AbstractControllerExecut
       break;
     }
 
-    if (first_cycle)
+    goal_mtx_.lock();
+    if (goal_handle.getGoalID().id != tracked_goal_id)
     {
-      // init oscillation pose
-      oscillation_pose = robot_pose_;
+      feedback_state.path_tracker.setPath(goal_handle.getGoal()->path.poses);
+      tracked_goal_id = goal_handle.getGoalID().id;
     }
 
-    goal_mtx_.lock();
     state_moving_input = execution.getState();
 
     switch (state_moving_input)
@@ -275,34 +291,27 @@ void ControllerAction::runImpl(GoalHandle &goal_handle, AbstractControllerExecut
         }
         else
         {
-          publishExePathFeedback(goal_handle, execution.getOutcome(), execution.getMessage(),
+          publishExePathFeedback(goal_handle, feedback_state, execution.getOutcome(), execution.getMessage(),
                                  execution.getVelocityCmd());
         }
         break;
 
       case AbstractControllerExecution::GOT_LOCAL_CMD:
-        if (!oscillation_timeout_.isZero())
+        if (oscillation_detector.update(robot_pose_))
         {
-          // check if oscillating
-          if (mbf_utility::distance(robot_pose_, oscillation_pose) >= oscillation_distance_ ||
-              mbf_utility::angle(robot_pose_, oscillation_pose) >= oscillation_angle_)
-          {
-            last_oscillation_reset = ros::Time::now();
-            oscillation_pose = robot_pose_;
-          }
-          else if (last_oscillation_reset + oscillation_timeout_ < ros::Time::now())
-          {
-            ROS_WARN_STREAM_NAMED(name_, "The controller is oscillating for "
-                << (ros::Time::now() - last_oscillation_reset).toSec() << "s");
-
-            execution.cancel();
-            controller_active = false;
-            fillExePathResult(mbf_msgs::ExePathResult::OSCILLATION, "Oscillation detected!", result);
-            goal_handle.setAborted(result, result.message);
-            break;
-          }
+          ROS_WARN_STREAM_NAMED(name_, "The controller is oscillating for "
+              << oscillation_detector.getWindowDuration().toSec() << "s (moved "
+              << oscillation_detector.getNetDistance() << "m along a " << oscillation_detector.getPathLength()
+              << "m path)");
+
+          execution.cancel();
+          controller_active = false;
+          fillExePathResult(mbf_msgs::ExePathResult::OSCILLATION, "Oscillation detected!", result);
+          goal_handle.setAborted(result, result.message);
+          break;
         }
-        publishExePathFeedback(goal_handle, execution.getOutcome(), execution.getMessage(), execution.getVelocityCmd());
+        publishExePathFeedback(goal_handle, feedback_state, execution.getOutcome(), execution.getMessage(),
+                               execution.getVelocityCmd());
         break;
 
       case AbstractControllerExecution::ARRIVED_GOAL:
@@ -345,7 +354,14 @@ void ControllerAction::runImpl(GoalHandle &goal_handle, AbstractControllerExecut
       execution.waitForStateUpdate(boost::chrono::milliseconds(500));
     }
 
-    first_cycle = false;
+    // report the control loop health once per second, and right away when it changes
+    const diagnostic_msgs::DiagnosticStatus health = execution.getHealth();
+    if (health.level != last_health_level || ros::Time::now() - last_health_time >= ros::Duration(1.0))
+    {
+      health_pub_.publish(health);
+      last_health_level = health.level;
+      last_health_time = ros::Time::now();
+    }
   }  // while (controller_active && ros::ok())
 
   if (!controller_active)
@@ -360,22 +376,43 @@ void ControllerAction::runImpl(GoalHandle &goal_handle, AbstractControllerExecut
 }
 
 void ControllerAction::publishExePathFeedback(
-        GoalHandle &goal_handle,
+        GoalHandle &goal_handle, FeedbackState &feedback_state,
         uint32_t outcome, const std::string &message,
         const geometry_msgs::TwistStamped &current_twist)
 {
+  // keep tracking the progress on every cycle, so it doesn't lag behind the robot
+  feedback_state.path_tracker.update(robot_pose_);
+
+  const ros::Time now = ros::Time::now();
+  if (outcome == feedback_state.last_outcome && !feedback_state.period.isZero() &&
+      now - feedback_state.last_time < feedback_state.period)
+  {
+    return;
+  }
+  feedback_state.last_time = now;
+  feedback_state.last_outcome = outcome;
+
   mbf_msgs::ExePathFeedback feedback;
   feedback.outcome = outcome;
   feedback.message = message;
 
   feedback.last_cmd_vel = current_twist;
   if (feedback.last_cmd_vel.header.stamp.isZero())
-    feedback.last_cmd_vel.header.stamp = ros::Time::now();
+    feedback.last_cmd_vel.header.stamp = now;
 
   feedback.current_pose = robot_pose_;
   feedback.dist_to_goal = static_cast<float>(mbf_utility::distance(robot_pose_, goal_pose_));
   feedback.angle_to_goal = static_cast<float>(mbf_utility::angle(robot_pose_, goal_pose_));
+  feedback.remaining_path_length = static_cast<float>(feedback_state.path_tracker.getRemainingLength());
+  feedback.path_segment_index = static_cast<uint32_t>(feedback_state.path_tracker.getSegmentIndex());
   goal_handle.publishFeedback(feedback);
+
+  if (compact_feedback_pub_.getNumSubscribers() > 0)
+  {
+    mbf_msgs::CompactFeedback compact_feedback;
+    mbf_utility::toCompactFeedback(feedback, goal_handle.getGoal()->concurrency_slot, compact_feedback);
+    compact_feedback_pub_.publish(compact_feedback);
+  }
 }
 
 void ControllerAction::fillExePathResult(
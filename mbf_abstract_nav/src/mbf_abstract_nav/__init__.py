@@ -21,6 +21,15 @@ def add_mbf_abstract_nav_params(gen):
             "How long the planner will wait in seconds in an attempt to find a valid plan before giving up", 5.0, 0, 100)
     gen.add("planner_max_retries", int_t, 0,
             "How many times we will recall the planner in an attempt to find a valid plan before giving up", -1, -1, 1000)
+    gen.add("replanning_prediction_horizon", double_t, 0,
+            "How far ahead in seconds to predict the robot pose used as start of the replanned paths; "
+            "0 plans from the current robot pose", 0.0, 0, 5)
+    gen.add("replanning_min_improvement", double_t, 0,
+            "Minimum relative reduction of the remaining path length for a replanned path to replace the current one; "
+            "0 replaces the current path with every new one", 0.0, 0, 1)
+    gen.add("replanning_max_divergence", double_t, 0,
+            "Replanned paths deviating more than this distance in meters from the remaining current path replace it "
+            "regardless of their length, as the way ahead has changed; 0 disables this check", 0.5, 0, 10)
 
     gen.add("controller_frequency", double_t, 0,
             "The rate in Hz at which to run the control loop and send velocity commands to the base", 20, 0, 100)
@@ -28,6 +37,15 @@ def add_mbf_abstract_nav_params(gen):
             "How long the controller will wait in seconds without receiving a valid control before giving up", 5.0, 0, 100)
     gen.add("controller_max_retries", int_t, 0,
             "How many times we will recall the controller in an attempt to find a valid command before giving up", -1, -1, 1000)
+    gen.add("controller_min_frequency", double_t, 0,
+            "Lowest rate in Hz the control loop can be slowed down to when the controller cannot keep up with "
+            "controller_frequency; 0 disables adapting the loop rate", 0.0, 0, 100)
+    gen.add("controller_max_utilization", double_t, 0,
+            "Maximum fraction of the control loop period the controller should spend computing; above it, the loop "
+            "rate is lowered (down to controller_min_frequency), and raised back once there is headroom", 0.8, 0.1, 1)
+    gen.add("controller_feedback_frequency", double_t, 0,
+            "Maximum rate in Hz at which to publish exe_path feedback; intermediate states are coalesced, but outcome "
+            "changes are published immediately. 0 publishes feedback on every control cycle", 0.0, 0, 100)
 
     gen.add("recovery_enabled", bool_t, 0,
             "Whether or not to enable the move_base_flex recovery behaviors to attempt to clear out space", True)
@@ -40,3 +58,7 @@ def add_mbf_abstract_nav_params(gen):
             "How far in meters the robot must move to be considered not to be oscillating", 0.5, 0, 10)
     gen.add("oscillation_angle", double_t, 0,
             "How far in radian the robot must rotate to be considered not to be oscillating", 3.14, 0, 6.28)
+    gen.add("oscillation_min_path_efficiency", double_t, 0,
+            "Minimum ratio between the distance the robot moves and the length of the path it travels over the "
+            "oscillation timeout to be considered not to be oscillating; catches back-and-forth motions. "
+            "0 disables this check", 0.0, 0, 1)
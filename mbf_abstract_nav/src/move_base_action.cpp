@@ -38,44 +38,67 @@
  *
  */
 
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
 #include <limits>
 
+#include <boost/make_shared.hpp>
+
 #include <mbf_utility/navigation_utility.h>
+#include <tf/transform_datatypes.h>
 
 #include "mbf_abstract_nav/MoveBaseFlexConfig.h"
 #include "mbf_abstract_nav/move_base_action.h"
 
 namespace mbf_abstract_nav
 {
+
 MoveBaseAction::MoveBaseAction(const std::string& name, const mbf_utility::RobotInformation& robot_info,
-                               const std::vector<std::string>& behaviors)
+                               const std::vector<std::string>& behaviors,
+                               const ActionClientGetPath::Ptr& action_client_get_path,
+                               const ActionClientExePath::Ptr& action_client_exe_path,
+                               const ActionClientRecovery::Ptr& action_client_recovery)
   : name_(name)
   , robot_info_(robot_info)
   , private_nh_("~")
-  , action_client_exe_path_(private_nh_, "exe_path")
-  , action_client_get_path_(private_nh_, "get_path")
-  , action_client_recovery_(private_nh_, "recovery")
-  , oscillation_timeout_(0)
-  , oscillation_distance_(0)
-  , oscillation_angle_(0)
+  , action_client_exe_path_(action_client_exe_path ? action_client_exe_path :
+      boost::make_shared<RosActionClient<mbf_msgs::ExePathAction> >(private_nh_, "exe_path"))
+  , action_client_get_path_(action_client_get_path ? action_client_get_path :
+      boost::make_shared<RosActionClient<mbf_msgs::GetPathAction> >(private_nh_, "get_path"))
+  , action_client_recovery_(action_client_recovery ? action_client_recovery :
+      boost::make_shared<RosActionClient<mbf_msgs::RecoveryAction> >(private_nh_, "recovery"))
+  , replanning_min_improvement_(0)
+  , replanning_max_divergence_(0)
   , replanning_thread_shutdown_(false)
+  , goal_trace_published_(true)
   , recovery_enabled_(true)
   , behaviors_(behaviors)
   , action_state_(NONE)
   , recovery_trigger_(NONE)
   , dist_to_goal_(std::numeric_limits<double>::infinity())
-  , replanning_thread_(boost::bind(&MoveBaseAction::replanningThread, this))
 {
+  goal_trace_pub_ = private_nh_.advertise<diagnostic_msgs::DiagnosticStatus>("move_base_trace", 10);
+  compact_feedback_pub_ = private_nh_.advertise<mbf_msgs::CompactFeedback>(name_ + "/compact_feedback", 10);
+
+  // start the replanning thread once all members are initialized
+  replanning_thread_ = boost::thread(boost::bind(&MoveBaseAction::replanningThread, this));
 }
 
 MoveBaseAction::~MoveBaseAction()
 {
   action_state_ = NONE;
   replanning_thread_shutdown_ = true;
+  wakeReplanningThread();
   if (replanning_thread_.joinable())
   {
     replanning_thread_.join();
   }
+
+  // release the clients before anything else, as they can still be running callbacks on this object
+  action_client_recovery_.reset();
+  action_client_exe_path_.reset();
+  action_client_get_path_.reset();
 }
 
 void MoveBaseAction::reconfigure(
@@ -85,100 +108,226 @@ void MoveBaseAction::reconfigure(
     replanning_period_.fromSec(1.0 / config.planner_frequency);
   else
     replanning_period_.fromSec(0.0);
-  oscillation_timeout_ = ros::Duration(config.oscillation_timeout);
-  oscillation_distance_ = config.oscillation_distance;
-  oscillation_angle_ = config.oscillation_angle;
+  replanning_prediction_horizon_.fromSec(config.replanning_prediction_horizon);
+  replanning_min_improvement_ = config.replanning_min_improvement;
+  replanning_max_divergence_ = config.replanning_max_divergence;
+  {
+    boost::lock_guard<boost::mutex> guard(oscillation_mtx_);
+    oscillation_detector_.setParams(ros::Duration(config.oscillation_timeout), config.oscillation_distance,
+                                    config.oscillation_angle, config.oscillation_min_path_efficiency);
+  }
   recovery_enabled_ = config.recovery_enabled;
+
+  // replanning could have been enabled or disabled
+  wakeReplanningThread();
 }
 
 void MoveBaseAction::cancel()
 {
+  boost::lock_guard<boost::recursive_mutex> guard(action_mtx_);
   action_state_ = CANCELED;
 
-  if (!action_client_get_path_.getState().isDone())
+  if (!action_client_get_path_->getState().isDone())
   {
-    action_client_get_path_.cancelGoal();
+    action_client_get_path_->cancelGoal();
   }
 
-  if (!action_client_exe_path_.getState().isDone())
+  if (!action_client_exe_path_->getState().isDone())
   {
-    action_client_exe_path_.cancelGoal();
+    action_client_exe_path_->cancelGoal();
   }
 
-  if (!action_client_recovery_.getState().isDone())
+  if (!action_client_recovery_->getState().isDone())
   {
-    action_client_recovery_.cancelGoal();
+    action_client_recovery_->cancelGoal();
   }
 }
 
 void MoveBaseAction::start(GoalHandle &goal_handle)
 {
-  dist_to_goal_ = std::numeric_limits<double>::infinity();
+  const mbf_msgs::MoveBaseGoal& goal = *goal_handle.getGoal();
 
-  action_state_ = GET_PATH;
+  {
+    boost::lock_guard<boost::recursive_mutex> guard(action_mtx_);
+    dist_to_goal_ = std::numeric_limits<double>::infinity();
 
-  goal_handle.setAccepted();
+    action_state_ = GET_PATH;
 
-  goal_handle_ = goal_handle;
+    goal_handle.setAccepted();
 
-  ROS_DEBUG_STREAM_NAMED("move_base", "Start action \"move_base\"");
+    goal_handle_ = goal_handle;
 
-  const mbf_msgs::MoveBaseGoal& goal = *goal_handle.getGoal();
+    resetGoalTrace();
+    traceGoalHop("goal_received");
 
-  get_path_goal_.target_pose = goal.target_pose;
-  get_path_goal_.use_start_pose = false; // use the robot pose
-  get_path_goal_.planner = goal.planner;
-  exe_path_goal_.controller = goal.controller;
+    ROS_DEBUG_STREAM_NAMED("move_base", "Start action \"move_base\"");
 
-  ros::Duration connection_timeout(1.0);
+    get_path_goal_.target_pose = goal.target_pose;
+    get_path_goal_.use_start_pose = false; // use the robot pose
+    get_path_goal_.planner = goal.planner;
+    exe_path_goal_.controller = goal.controller;
+
+    {
+      boost::lock_guard<boost::mutex> guard(oscillation_mtx_);
+      oscillation_detector_.reset();
+    }
 
-  last_oscillation_reset_ = ros::Time::now();
+    // start recovering with the first behavior, use the recovery behaviors from the action request, if specified,
+    // otherwise, use all loaded behaviors.
 
-  // start recovering with the first behavior, use the recovery behaviors from the action request, if specified,
-  // otherwise, use all loaded behaviors.
+    recovery_behaviors_ = goal.recovery_behaviors.empty() ? behaviors_ : goal.recovery_behaviors;
+    current_recovery_behavior_ = recovery_behaviors_.begin();
+    goal_pose_ = goal.target_pose;
+  }
 
-  recovery_behaviors_ = goal.recovery_behaviors.empty() ? behaviors_ : goal.recovery_behaviors;
-  current_recovery_behavior_ = recovery_behaviors_.begin();
+  // the potentially slow calls are done unlocked, so they don't hold cancel requests and the actions' callbacks
 
   // get the current robot pose only at the beginning, as exe_path will keep updating it as we move
-  if (!robot_info_.getRobotPose(robot_pose_))
-  {
-    ROS_ERROR_STREAM_NAMED("move_base", "Could not get the current robot pose!");
-    move_base_result_.message = "Could not get the current robot pose!";
-    move_base_result_.outcome = mbf_msgs::MoveBaseResult::TF_ERROR;
-    goal_handle.setAborted(move_base_result_, move_base_result_.message);
-    return;
-  }
-  goal_pose_ = goal.target_pose;
-  last_oscillation_pose_ = robot_pose_;
+  geometry_msgs::PoseStamped robot_pose;
+  const bool got_robot_pose = robot_info_.getRobotPose(robot_pose);
 
   // wait for server connections
-  if (!action_client_get_path_.waitForServer(connection_timeout) ||
-      !action_client_exe_path_.waitForServer(connection_timeout) ||
-      !action_client_recovery_.waitForServer(connection_timeout))
+  ros::Duration connection_timeout(1.0);
+  const bool connected = got_robot_pose &&
+                         action_client_get_path_->waitForServer(connection_timeout) &&
+                         action_client_exe_path_->waitForServer(connection_timeout) &&
+                         action_client_recovery_->waitForServer(connection_timeout);
+
+  mbf_msgs::GetPathGoal get_path_goal;
   {
-    ROS_ERROR_STREAM_NAMED("move_base", "Could not connect to one or more of move_base_flex actions: "
-        "\"get_path\", \"exe_path\", \"recovery \"!");
-    move_base_result_.outcome = mbf_msgs::MoveBaseResult::INTERNAL_ERROR;
-    move_base_result_.message = "Could not connect to the move_base_flex actions!";
-    goal_handle.setAborted(move_base_result_, move_base_result_.message);
-    return;
+    boost::lock_guard<boost::recursive_mutex> guard(action_mtx_);
+    if (goal_handle_ != goal_handle)
+    {
+      return;  // replaced by a new goal meanwhile, that takes over
+    }
+
+    if (action_state_ == CANCELED)
+    {
+      ROS_INFO_STREAM_NAMED("move_base", "move_base canceled before starting get_path");
+      move_base_result_.outcome = mbf_msgs::MoveBaseResult::CANCELED;
+      move_base_result_.message = "Canceled before starting planning";
+      goal_handle.setCanceled(move_base_result_, move_base_result_.message);
+      return;
+    }
+
+    if (!got_robot_pose)
+    {
+      ROS_ERROR_STREAM_NAMED("move_base", "Could not get the current robot pose!");
+      move_base_result_.message = "Could not get the current robot pose!";
+      move_base_result_.outcome = mbf_msgs::MoveBaseResult::TF_ERROR;
+      goal_handle.setAborted(move_base_result_, move_base_result_.message);
+      action_state_ = FAILED;
+      return;
+    }
+
+    if (!connected)
+    {
+      ROS_ERROR_STREAM_NAMED("move_base", "Could not connect to one or more of move_base_flex actions: "
+          "\"get_path\", \"exe_path\", \"recovery \"!");
+      move_base_result_.outcome = mbf_msgs::MoveBaseResult::INTERNAL_ERROR;
+      move_base_result_.message = "Could not connect to the move_base_flex actions!";
+      goal_handle.setAborted(move_base_result_, move_base_result_.message);
+      action_state_ = FAILED;
+      return;
+    }
+    traceGoalHop("servers_connected");
+
+    robot_pose_ = robot_pose;
+    get_path_goal = get_path_goal_;
   }
 
   // call get_path action server to get a first plan
-  action_client_get_path_.sendGoal(
-      get_path_goal_,
+  action_client_get_path_->sendGoal(
+      get_path_goal,
       boost::bind(&MoveBaseAction::actionGetPathDone, this, _1, _2));
+  traceGoalHop("get_path_sent");
+
+  // a cancel arriving while sending found no get_path goal to cancel; it's our job, then
+  boost::lock_guard<boost::recursive_mutex> guard(action_mtx_);
+  if (goal_handle_ == goal_handle && action_state_ == CANCELED &&
+      !action_client_get_path_->getState().isDone())
+  {
+    action_client_get_path_->cancelGoal();
+  }
+}
+
+void MoveBaseAction::resetGoalTrace()
+{
+  boost::lock_guard<boost::mutex> guard(goal_trace_mtx_);
+  goal_trace_.clear();
+  goal_trace_published_ = false;
+}
+
+void MoveBaseAction::traceGoalHop(const std::string &hop, const ros::Time &stamp)
+{
+  boost::lock_guard<boost::mutex> guard(goal_trace_mtx_);
+  if (!goal_trace_published_)
+  {
+    goal_trace_.push_back(std::make_pair(hop, stamp));
+  }
+}
+
+void MoveBaseAction::publishGoalTrace()
+{
+  boost::lock_guard<boost::mutex> guard(goal_trace_mtx_);
+  if (goal_trace_published_ || goal_trace_.empty())
+  {
+    return;
+  }
+  goal_trace_published_ = true;
+
+  const std::string &trace_id = goal_handle_.getGoalID().id;
+  const ros::Time &goal_received = goal_trace_.front().second;
+
+  diagnostic_msgs::DiagnosticStatus status;
+  status.level = diagnostic_msgs::DiagnosticStatus::OK;
+  status.name = name_;
+  diagnostic_msgs::KeyValue key_value;
+  key_value.key = "trace_id";
+  key_value.value = trace_id;
+  status.values.push_back(key_value);
+
+  std::stringstream timeline;
+  std::vector<std::pair<std::string, ros::Time> >::const_iterator hop;
+  for (hop = goal_trace_.begin(); hop != goal_trace_.end(); ++hop)
+  {
+    std::stringstream latency;
+    latency << std::fixed << std::setprecision(2) << (hop->second - goal_received).toSec() * 1e3;
+    key_value.key = hop->first;
+    key_value.value = latency.str();
+    status.values.push_back(key_value);
+    timeline << " " << hop->first << ": " << latency.str() << " ms;";
+  }
+  std::stringstream message;
+  message << "Goal " << trace_id << " reached \"" << goal_trace_.back().first << "\" after "
+          << (goal_trace_.back().second - goal_received).toSec() * 1e3 << " ms";
+  status.message = message.str();
+  goal_trace_pub_.publish(status);
+
+  ROS_DEBUG_STREAM_NAMED("move_base", "Timeline of goal " << trace_id << ":" << timeline.str());
 }
 
 void MoveBaseAction::actionExePathActive()
 {
+  boost::lock_guard<boost::recursive_mutex> guard(action_mtx_);
   ROS_DEBUG_STREAM_NAMED("move_base", "The \"exe_path\" action is active.");
+  traceGoalHop("exe_path_active");
 }
 
 void MoveBaseAction::actionExePathFeedback(
     const mbf_msgs::ExePathFeedbackConstPtr &feedback)
 {
+  boost::lock_guard<boost::recursive_mutex> guard(action_mtx_);
+  // the timeline ends with the first velocity command computed by the controller, whose stamp comes with the first
+  // feedback reporting a command; other feedbacks are stamped when sent, so they don't tell us when it was computed
+  if (feedback->outcome == mbf_msgs::ExePathResult::SUCCESS && !feedback->last_cmd_vel.header.stamp.isZero())
+  {
+    // these calls do nothing once the timeline of the goal has been published
+    traceGoalHop("first_cmd_vel", feedback->last_cmd_vel.header.stamp);
+    traceGoalHop("first_feedback");
+    publishGoalTrace();
+  }
+
   mbf_msgs::MoveBaseFeedback move_base_feedback;
   move_base_feedback.outcome = feedback->outcome;
   move_base_feedback.message = feedback->message;
@@ -186,24 +335,33 @@ void MoveBaseAction::actionExePathFeedback(
   move_base_feedback.dist_to_goal = feedback->dist_to_goal;
   move_base_feedback.current_pose = feedback->current_pose;
   move_base_feedback.last_cmd_vel = feedback->last_cmd_vel;
+  move_base_feedback.remaining_path_length = feedback->remaining_path_length;
+  move_base_feedback.path_segment_index = feedback->path_segment_index;
   goal_handle_.publishFeedback(move_base_feedback);
-  dist_to_goal_ = feedback->dist_to_goal;
+  if (compact_feedback_pub_.getNumSubscribers() > 0)
+  {
+    mbf_msgs::CompactFeedback compact_feedback;
+    mbf_utility::toCompactFeedback(*feedback, 0, compact_feedback);
+    compact_feedback_pub_.publish(compact_feedback);
+  }
+  const bool was_replanning = replanningActive();
+  dist_to_goal_ = feedback->remaining_path_length;
   robot_pose_ = feedback->current_pose;
+  if (!was_replanning && replanningActive())
+  {
+    wakeReplanningThread();
+  }
 
   // we create a navigation-level oscillation detection using exe_path action's feedback,
   // as the latter doesn't handle oscillations created by quickly failing repeated plans
 
   // if oscillation detection is enabled by oscillation_timeout != 0
-  if (!oscillation_timeout_.isZero())
+  boost::unique_lock<boost::mutex> oscillation_lock(oscillation_mtx_);
+  if (oscillation_detector_.isEnabled())
   {
-    // check if oscillating
-    // moved more than the minimum oscillation distance
-    if (mbf_utility::distance(robot_pose_, last_oscillation_pose_) >= oscillation_distance_ ||
-        mbf_utility::angle(robot_pose_, last_oscillation_pose_) >= oscillation_angle_)
+    const bool oscillating = oscillation_detector_.update(robot_pose_);
+    if (oscillation_detector_.isProgressing())
     {
-      last_oscillation_reset_ = ros::Time::now();
-      last_oscillation_pose_ = robot_pose_;
-
       if (recovery_trigger_ == OSCILLATING)
       {
         ROS_INFO_NAMED("move_base", "Recovered from robot oscillation: restart recovery behaviors");
@@ -211,12 +369,13 @@ void MoveBaseAction::actionExePathFeedback(
         recovery_trigger_ = NONE;
       }
     }
-    else if (last_oscillation_reset_ + oscillation_timeout_ < ros::Time::now())
+    else if (oscillating)
     {
       std::stringstream oscillation_msgs;
-      oscillation_msgs << "Robot is oscillating for " << (ros::Time::now() - last_oscillation_reset_).toSec() << "s!";
+      oscillation_msgs << "Robot is oscillating for " << oscillation_detector_.getWindowDuration().toSec() << "s!";
+      oscillation_lock.unlock();
       ROS_WARN_STREAM_NAMED("move_base", oscillation_msgs.str());
-      action_client_exe_path_.cancelGoal();
+      action_client_exe_path_->cancelGoal();
 
       if (attemptRecovery())
       {
@@ -239,6 +398,7 @@ void MoveBaseAction::actionGetPathDone(
     const actionlib::SimpleClientGoalState &state,
     const mbf_msgs::GetPathResultConstPtr &result_ptr)
 {
+  boost::lock_guard<boost::recursive_mutex> guard(action_mtx_);
   const mbf_msgs::GetPathResult &get_path_result = *result_ptr;
 
   // copy result from get_path action
@@ -254,6 +414,7 @@ void MoveBaseAction::actionGetPathDone(
       ROS_DEBUG_STREAM_NAMED("move_base", "Action \""
           << "move_base\" received a path from \""
           << "get_path\": " << state.getText());
+      traceGoalHop("get_path_done");
 
       exe_path_goal_.path = get_path_result.path;
       ROS_DEBUG_STREAM_NAMED("move_base", "Action \""
@@ -267,16 +428,17 @@ void MoveBaseAction::actionGetPathDone(
         recovery_trigger_ = NONE;
       }
 
-      action_client_exe_path_.sendGoal(
+      action_client_exe_path_->sendGoal(
           exe_path_goal_,
           boost::bind(&MoveBaseAction::actionExePathDone, this, _1, _2),
           boost::bind(&MoveBaseAction::actionExePathActive, this),
           boost::bind(&MoveBaseAction::actionExePathFeedback, this, _1));
+      traceGoalHop("exe_path_sent");
       action_state_ = EXE_PATH;
       break;
 
     case actionlib::SimpleClientGoalState::ABORTED:
-      if (!action_client_exe_path_.getState().isDone())
+      if (!action_client_exe_path_->getState().isDone())
       {
         ROS_WARN_STREAM_NAMED("move_base", "Cancel previous goal, as planning to the new one has failed");
         cancel();
@@ -323,14 +485,22 @@ void MoveBaseAction::actionGetPathDone(
       action_state_ = FAILED;
       break;
   }
+
+  // get_path is available again, and we could have started following a path
+  wakeReplanningThread();
 }
 
 void MoveBaseAction::actionExePathDone(
     const actionlib::SimpleClientGoalState &state,
     const mbf_msgs::ExePathResultConstPtr &result_ptr)
 {
+  boost::lock_guard<boost::recursive_mutex> guard(action_mtx_);
   ROS_DEBUG_STREAM_NAMED("move_base", "Action \"exe_path\" finished.");
 
+  // publish whatever we have traced, in case exe_path finished before providing any feedback
+  traceGoalHop("exe_path_done");
+  publishGoalTrace();
+
   const mbf_msgs::ExePathResult& exe_path_result = *result_ptr;
 
   // copy result from exe_path action
@@ -433,7 +603,7 @@ bool MoveBaseAction::attemptRecovery()
   recovery_goal_.behavior = *current_recovery_behavior_;
   ROS_DEBUG_STREAM_NAMED("move_base", "Start recovery behavior\""
       << *current_recovery_behavior_ <<"\".");
-  action_client_recovery_.sendGoal(
+  action_client_recovery_->sendGoal(
       recovery_goal_,
       boost::bind(&MoveBaseAction::actionRecoveryDone, this, _1, _2)
   );
@@ -445,8 +615,12 @@ void MoveBaseAction::actionRecoveryDone(
     const actionlib::SimpleClientGoalState &state,
     const mbf_msgs::RecoveryResultConstPtr &result_ptr)
 {
+  boost::lock_guard<boost::recursive_mutex> guard(action_mtx_);
   // give the robot some time to stop oscillating after executing the recovery behavior
-  last_oscillation_reset_ = ros::Time::now();
+  {
+    boost::lock_guard<boost::mutex> guard(oscillation_mtx_);
+    oscillation_detector_.reset();
+  }
 
   const mbf_msgs::RecoveryResult& recovery_result = *result_ptr;
 
@@ -490,7 +664,7 @@ void MoveBaseAction::actionRecoveryDone(
                              "Try planning again and increment the current recovery behavior in the list.");
       action_state_ = GET_PATH;
       current_recovery_behavior_++; // use next behavior, the next time;
-      action_client_get_path_.sendGoal(
+      action_client_get_path_->sendGoal(
           get_path_goal_,
           boost::bind(&MoveBaseAction::actionGetPathDone, this, _1, _2)
       );
@@ -509,52 +683,164 @@ void MoveBaseAction::actionRecoveryDone(
   }
 }
 
+void MoveBaseAction::actionGetPathReplanningDone(
+    const actionlib::SimpleClientGoalState &state,
+    const mbf_msgs::GetPathResultConstPtr &result)
+{
+  boost::lock_guard<boost::recursive_mutex> guard(action_mtx_);
+  std::string reason;
+  if (state == actionlib::SimpleClientGoalState::SUCCEEDED && replanningActive() &&
+      !acceptReplannedPath(result->path, reason))
+  {
+    ROS_DEBUG_STREAM_NAMED("move_base", "Replanning succeeded, but we keep following the current plan: " << reason);
+  }
+  else if (state == actionlib::SimpleClientGoalState::SUCCEEDED && replanningActive())
+  {
+    ROS_DEBUG_STREAM_NAMED("move_base", "Replanning succeeded; sending a goal to \"exe_path\" with the new plan: "
+                                        << reason);
+    exe_path_goal_.path = result->path;
+    mbf_msgs::ExePathGoal goal(exe_path_goal_);
+    action_client_exe_path_->sendGoal(goal, boost::bind(&MoveBaseAction::actionExePathDone, this, _1, _2),
+                                      boost::bind(&MoveBaseAction::actionExePathActive, this),
+                                      boost::bind(&MoveBaseAction::actionExePathFeedback, this, _1));
+  }
+  else if (state == actionlib::SimpleClientGoalState::SUCCEEDED)
+  {
+    ROS_DEBUG_STREAM_NAMED("move_base", "Replanning succeeded, but we are not following a path anymore");
+  }
+  else
+  {
+    ROS_DEBUG_STREAM_NAMED("move_base",
+                           "Replanning failed with error code " << result->outcome << ": " << result->message);
+  }
+
+  // get_path is available again for the next replanning cycle
+  wakeReplanningThread();
+}
+
+bool MoveBaseAction::acceptReplannedPath(const std::vector<geometry_msgs::PoseStamped> &new_path,
+                                         std::string &reason) const
+{
+  const std::vector<geometry_msgs::PoseStamped> &current_path = exe_path_goal_.path;
+  if (replanning_min_improvement_ <= 0.0 || current_path.empty() || new_path.empty())
+  {
+    reason = "plan comparison disabled";
+    return true;
+  }
+
+  // compare with what remains of the current path, from the pose closest to the robot
+  const size_t closest = mbf_utility::closestPose(current_path, robot_pose_);
+  const double remaining_length = mbf_utility::pathLength(current_path.begin() + closest, current_path.end());
+
+  // the new path can start ahead of the robot, if planned from a predicted pose
+  const double new_length = mbf_utility::distance(robot_pose_, new_path.front()) +
+                            mbf_utility::pathLength(new_path.begin(), new_path.end());
+
+  std::stringstream explanation;
+  explanation << "new path length: " << new_length << ", remaining length: " << remaining_length;
+
+  if (replanning_max_divergence_ > 0.0)
+  {
+    // sample the new path and find the largest distance to the remaining current path
+    const size_t max_samples = 32;
+    const size_t step = std::max<size_t>(1, new_path.size() / max_samples);
+    double divergence = 0.0;
+    for (size_t i = 0; i < new_path.size(); i += step)
+    {
+      double min_dist = std::numeric_limits<double>::infinity();
+      for (size_t j = closest; j < current_path.size(); ++j)
+      {
+        min_dist = std::min(min_dist, mbf_utility::distance(new_path[i], current_path[j]));
+      }
+      divergence = std::max(divergence, min_dist);
+    }
+    explanation << ", divergence: " << divergence;
+
+    if (divergence > replanning_max_divergence_)
+    {
+      reason = explanation.str();
+      return true;
+    }
+  }
+
+  reason = explanation.str();
+  return new_length < remaining_length * (1.0 - replanning_min_improvement_);
+}
+
+bool MoveBaseAction::predictRobotPose(const ros::Duration &horizon, geometry_msgs::PoseStamped &predicted_pose) const
+{
+  geometry_msgs::TwistStamped robot_velocity;
+  if (!robot_info_.getRobotPose(predicted_pose) || !robot_info_.getRobotVelocity(robot_velocity))
+  {
+    return false;
+  }
+
+  // assume the robot keeps its current velocity over the horizon
+  mbf_utility::predictPose(predicted_pose, robot_velocity.twist, horizon, predicted_pose);
+  return true;
+}
+
 bool MoveBaseAction::replanningActive() const
 {
   // replan only while following a path and if replanning is enabled (can be disabled by dynamic reconfigure)
   return !replanning_period_.isZero() && action_state_ == EXE_PATH && dist_to_goal_ > 0.1;
 }
 
+void MoveBaseAction::wakeReplanningThread()
+{
+  boost::lock_guard<boost::mutex> guard(replanning_mtx_);
+  replanning_cv_.notify_all();
+}
+
 void MoveBaseAction::replanningThread()
 {
-  ros::Duration update_period(0.005);
   ros::Time last_replan_time = ros::Time::now();
 
+  boost::unique_lock<boost::mutex> lock(replanning_mtx_);
   while (ros::ok() && !replanning_thread_shutdown_)
   {
-    if (!action_client_get_path_.getState().isDone())
+    if (!replanningActive())
     {
-      if (action_client_get_path_.waitForResult(update_period))
-      {
-        actionlib::SimpleClientGoalState state = action_client_get_path_.getState();
-        mbf_msgs::GetPathResultConstPtr result = action_client_get_path_.getResult();
-        if (state == actionlib::SimpleClientGoalState::SUCCEEDED && replanningActive())
-        {
-          ROS_DEBUG_STREAM_NAMED("move_base", "Replanning succeeded; sending a goal to \"exe_path\" with the new plan");
-          exe_path_goal_.path = result->path;
-          mbf_msgs::ExePathGoal goal(exe_path_goal_);
-          action_client_exe_path_.sendGoal(goal, boost::bind(&MoveBaseAction::actionExePathDone, this, _1, _2),
-                                           boost::bind(&MoveBaseAction::actionExePathActive, this),
-                                           boost::bind(&MoveBaseAction::actionExePathFeedback, this, _1));
-        }
-        else
-        {
-          ROS_DEBUG_STREAM_NAMED("move_base",
-                                 "Replanning failed with error code " << result->outcome << ": " << result->message);
-        }
-      }
-      // else keep waiting for planning to complete (we already waited update_period in waitForResult)
+      // nothing to do until we start following a path; the replanning period counts from then
+      replanning_cv_.wait(lock);
+      last_replan_time = ros::Time::now();
     }
-    else if (!replanningActive())
+    else if (!action_client_get_path_->getState().isDone())
     {
-      last_replan_time = ros::Time::now();
-      update_period.sleep();
+      // a plan is being computed, either by us or for a new goal; we get woken up when it's done
+      replanning_cv_.wait(lock);
     }
-    else if (ros::Time::now() - last_replan_time >= replanning_period_)
+    else
     {
+      const ros::Duration time_to_replan = last_replan_time + replanning_period_ - ros::Time::now();
+      if (time_to_replan > ros::Duration(0))
+      {
+        replanning_cv_.wait_for(lock, boost::chrono::nanoseconds(time_to_replan.toNSec()));
+        continue;
+      }
+
       ROS_DEBUG_STREAM_NAMED("move_base", "Next replanning cycle, using the \"get_path\" action!");
-      action_client_get_path_.sendGoal(get_path_goal_);
       last_replan_time = ros::Time::now();
+
+      // don't hold the lock while sending, as the action could finish (and wake us up) right away; neither while
+      // taking the action lock, as the action callbacks wake us up while holding it
+      lock.unlock();
+
+      // plan from where the robot will be when the new plan is ready, if so configured
+      mbf_msgs::GetPathGoal goal;
+      {
+        boost::lock_guard<boost::recursive_mutex> guard(action_mtx_);
+        goal = get_path_goal_;
+      }
+      if (!replanning_prediction_horizon_.isZero() &&
+          predictRobotPose(replanning_prediction_horizon_, goal.start_pose))
+      {
+        goal.use_start_pose = true;
+      }
+
+      action_client_get_path_->sendGoal(goal,
+                                        boost::bind(&MoveBaseAction::actionGetPathReplanningDone, this, _1, _2));
+      lock.lock();
     }
   }
 }
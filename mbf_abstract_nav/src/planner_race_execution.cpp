@@ -0,0 +1,259 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  planner_race_execution.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+
+#include <mbf_msgs/GetPathResult.h>
+
+#include "mbf_abstract_nav/planner_race_execution.h"
+
+namespace mbf_abstract_nav
+{
+
+PlannerRaceExecution::PlannerRaceExecution(const std::string &name,
+                                           const std::vector<AbstractPlannerExecution::Ptr> &contenders,
+                                           RaceMode mode,
+                                           const ros::Duration &deadline,
+                                           const mbf_utility::RobotInformation &robot_info,
+                                           const Settings::ConstPtr &settings,
+                                           const MoveBaseFlexConfig &config)
+  : AbstractPlannerExecution(name, mbf_abstract_core::AbstractPlanner::Ptr(), robot_info, settings, config)
+  , contenders_(contenders)
+  , mode_(mode)
+  , deadline_(deadline)
+  , state_update_(boost::make_shared<StateUpdate>())
+{
+  std::vector<AbstractPlannerExecution::Ptr>::const_iterator it;
+  for (it = contenders_.begin(); it != contenders_.end(); ++it)
+  {
+    (*it)->setStateCallback(boost::bind(&StateUpdate::notify, state_update_));
+  }
+}
+
+PlannerRaceExecution::~PlannerRaceExecution()
+{
+}
+
+void PlannerRaceExecution::StateUpdate::notify()
+{
+  // notify under the lock, so the race cannot miss it between checking the contenders and waiting
+  boost::lock_guard<boost::mutex> guard(mutex);
+  condition.notify_all();
+}
+
+bool PlannerRaceExecution::parseRaceMode(const std::string &mode_name, RaceMode &mode)
+{
+  if (mode_name == "first")
+  {
+    mode = FIRST;
+    return true;
+  }
+  if (mode_name == "best")
+  {
+    mode = BEST;
+    return true;
+  }
+  return false;
+}
+
+std::string PlannerRaceExecution::getWinner() const
+{
+  boost::lock_guard<boost::mutex> guard(winner_mtx_);
+  return winner_;
+}
+
+bool PlannerRaceExecution::cancel()
+{
+  cancel_ = true; // force cancel immediately; the contenders can take a while to react
+  state_update_->notify();
+  return cancelContenders();
+}
+
+bool PlannerRaceExecution::cancelContenders()
+{
+  bool canceled = false;
+  std::vector<AbstractPlannerExecution::Ptr>::const_iterator it;
+  for (it = contenders_.begin(); it != contenders_.end(); ++it)
+  {
+    const PlanningState state = (*it)->getState();
+    if (state == STARTED || state == PLANNING)
+    {
+      canceled = (*it)->cancel() || canceled;
+    }
+  }
+  return canceled;
+}
+
+uint32_t PlannerRaceExecution::makePlan(const geometry_msgs::PoseStamped &start,
+                                        const geometry_msgs::PoseStamped &goal,
+                                        double tolerance,
+                                        std::vector<geometry_msgs::PoseStamped> &plan,
+                                        double &cost,
+                                        std::string &message)
+{
+  {
+    boost::lock_guard<boost::mutex> guard(winner_mtx_);
+    winner_.clear();
+  }
+
+  // start all the contenders; when retrying, a contender can be still busy with the previous attempt if its plugin
+  // doesn't support canceling, so we just leave it out of this one (the race owns it until it finishes)
+  std::vector<AbstractPlannerExecution::Ptr> running;
+  std::vector<AbstractPlannerExecution::Ptr>::const_iterator it;
+  for (it = contenders_.begin(); it != contenders_.end(); ++it)
+  {
+    if ((*it)->start(start, goal, tolerance))
+    {
+      running.push_back(*it);
+    }
+    else
+    {
+      ROS_WARN_STREAM("The planner \"" << (*it)->getName() << "\" is still busy; it will not take part in the race \""
+                      << name_ << "\"");
+    }
+  }
+
+  if (running.empty())
+  {
+    message = "None of the planners of the race \"" + name_ + "\" could be started";
+    return mbf_msgs::GetPathResult::INTERNAL_ERROR;
+  }
+
+  const ros::Time deadline = ros::Time::now() + deadline_;
+  AbstractPlannerExecution::Ptr winner;
+  uint32_t outcome = mbf_msgs::GetPathResult::NO_PATH_FOUND;
+  message = "No planner of the race \"" + name_ + "\" found a plan";
+
+  boost::unique_lock<boost::mutex> lock(state_update_->mutex);
+  while (!running.empty() && !cancel_)
+  {
+    // collect the contenders that have finished since the last check
+    std::vector<AbstractPlannerExecution::Ptr>::iterator r_it = running.begin();
+    while (r_it != running.end())
+    {
+      const PlanningState state = (*r_it)->getState();
+      if (state == INITIALIZED || state == STARTED || state == PLANNING)
+      {
+        ++r_it;
+        continue;
+      }
+
+      if (state == FOUND_PLAN)
+      {
+        ROS_DEBUG_STREAM("The planner \"" << (*r_it)->getName() << "\" found a plan with cost "
+                         << (*r_it)->getCost() << " in the race \"" << name_ << "\"");
+        if (!winner || (*r_it)->getCost() < winner->getCost())
+        {
+          winner = *r_it;
+        }
+      }
+      else
+      {
+        ROS_DEBUG_STREAM("The planner \"" << (*r_it)->getName() << "\" failed in the race \"" << name_ << "\": "
+                         << (*r_it)->getMessage());
+        outcome = (*r_it)->getOutcome();
+        message = (*r_it)->getMessage();
+      }
+      r_it = running.erase(r_it);
+    }
+
+    if (winner && mode_ == FIRST)
+    {
+      break;
+    }
+
+    if (!deadline_.isZero() && ros::Time::now() >= deadline)
+    {
+      ROS_INFO_STREAM("The deadline (" << deadline_.toSec() << "s) of the planner race \"" << name_
+                      << "\" has expired with " << running.size() << " planners still running");
+      if (!winner)
+      {
+        outcome = mbf_msgs::GetPathResult::PAT_EXCEEDED;
+        message = "No planner of the race \"" + name_ + "\" found a plan before the deadline";
+      }
+      break;
+    }
+
+    if (running.empty())
+    {
+      break;
+    }
+
+    // wait until any contender finishes, the race gets canceled or the deadline expires
+    if (deadline_.isZero())
+    {
+      state_update_->condition.wait(lock);
+    }
+    else
+    {
+      const ros::Duration remaining = deadline - ros::Time::now();
+      state_update_->condition.wait_for(lock, boost::chrono::microseconds(remaining.toNSec() / 1000));
+    }
+  }
+  lock.unlock();
+
+  // the race is decided; cancel the losers still planning (they get uncanceled when started on the next race)
+  cancelContenders();
+
+  if (cancel_)
+  {
+    message = "The planner race \"" + name_ + "\" has been canceled";
+    return mbf_msgs::GetPathResult::CANCELED;
+  }
+
+  if (!winner)
+  {
+    return outcome;
+  }
+
+  ROS_INFO_STREAM("The planner \"" << winner->getName() << "\" won the race \"" << name_ << "\" with cost "
+                  << winner->getCost());
+  {
+    boost::lock_guard<boost::mutex> guard(winner_mtx_);
+    winner_ = winner->getName();
+  }
+  plan = winner->getPlan();
+  cost = winner->getCost();
+  message = winner->getMessage();
+  return winner->getOutcome();
+}
+
+} /* namespace mbf_abstract_nav */
@@ -1,6 +1,12 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <string>
+#include <vector>
+
+#include <boost/chrono.hpp>
+#include <boost/thread/condition_variable.hpp>
+
 // dummy message
 #include <mbf_msgs/GetPathAction.h>
 #include <mbf_utility/robot_information.h>
@@ -22,6 +28,31 @@ protected:
   MOCK_METHOD0(run, void());
 };
 
+// mocked action server, so we can get real goal handles; we cannot mock them
+struct MockedActionServer : public actionlib::ActionServerBase<mbf_msgs::GetPathAction>
+{
+  typedef actionlib::ServerGoalHandle<mbf_msgs::GetPathAction> GoalHandle;
+
+  MockedActionServer(boost::function<void(GoalHandle)> goal_cb, boost::function<void(GoalHandle)> cancel_cb)
+    : actionlib::ActionServerBase<mbf_msgs::GetPathAction>(goal_cb, cancel_cb, true)
+  {
+  }
+
+  MOCK_METHOD2(publishResult, void(const actionlib_msgs::GoalStatus&, const Result&));
+
+  virtual void initialize()
+  {
+  }
+
+  void publishFeedback(const actionlib_msgs::GoalStatus&, const Feedback&)
+  {
+  }
+
+  void publishStatus()
+  {
+  }
+};
+
 using testing::Test;
 
 // fixture with access to the AbstractActionBase's internals
@@ -33,14 +64,80 @@ struct AbstractActionBaseFixture
   std::string test_name;
   mbf_utility::RobotInformation ri;
 
+  // goals go through this server into start and cancel
+  MockedActionServer action_server_;
+  MockedExecution::Ptr next_execution_;
+
+  // runImpl records the goals it runs, and blocks while held, so we can queue goals on a busy slot
+  boost::mutex run_mtx_;
+  boost::condition_variable run_cv_;
+  std::vector<std::string> run_goals_;
+  bool hold_runs_;
+
   AbstractActionBaseFixture()
       : test_name("action_base"),
         ri(tf_, "global_frame", "local_frame", ros::Duration()),
-        AbstractActionBase(test_name, ri)
+        AbstractActionBase(test_name, ri),
+        action_server_(boost::bind(&AbstractActionBaseFixture::goalCallback, this, _1),
+                       boost::bind(&AbstractActionBaseFixture::cancelCallback, this, _1)),
+        hold_runs_(false)
   {
   }
 
-  void runImpl(GoalHandle &goal_handle, MockedExecution &execution) {}
+  void runImpl(GoalHandle &goal_handle, MockedExecution &execution)
+  {
+    boost::unique_lock<boost::mutex> lock(run_mtx_);
+    run_goals_.push_back(goal_handle.getGoalID().id);
+    run_cv_.notify_all();
+    while (hold_runs_)
+      run_cv_.wait(lock);
+  }
+
+  void goalCallback(GoalHandle goal_handle)
+  {
+    start(goal_handle, next_execution_);
+  }
+
+  void cancelCallback(GoalHandle goal_handle)
+  {
+    cancel(goal_handle);
+  }
+
+  // sends a goal through the action server, to be run by the given execution
+  void sendGoal(const std::string &id, unsigned char slot, const MockedExecution::Ptr &execution)
+  {
+    mbf_msgs::GetPathActionGoalPtr goal(new mbf_msgs::GetPathActionGoal());
+    goal->goal_id.id = id;
+    goal->goal.concurrency_slot = slot;
+    next_execution_ = execution;
+    action_server_.goalCallback(goal);
+  }
+
+  void cancelGoal(const std::string &id)
+  {
+    actionlib_msgs::GoalIDPtr goal_id(new actionlib_msgs::GoalID());
+    goal_id->id = id;
+    action_server_.cancelCallback(goal_id);
+  }
+
+  // waits for runImpl to start running the given number of goals
+  void waitForRuns(size_t runs)
+  {
+    boost::unique_lock<boost::mutex> lock(run_mtx_);
+    while (run_goals_.size() < runs)
+      run_cv_.wait_for(lock, boost::chrono::milliseconds(100));
+  }
+
+  // lets the held runs finish, and waits for the slot thread to complete
+  void releaseRuns(unsigned char slot)
+  {
+    {
+      boost::lock_guard<boost::mutex> guard(run_mtx_);
+      hold_runs_ = false;
+      run_cv_.notify_all();
+    }
+    concurrency_slots_[slot].thread_ptr->join();
+  }
 };
 
 TEST_F(AbstractActionBaseFixture, thread_stop)
@@ -52,8 +149,17 @@ TEST_F(AbstractActionBaseFixture, thread_stop)
                                          boost::ref(concurrency_slots_[slot])));
 }
 
+using testing::_;
+using testing::ElementsAre;
+using testing::Field;
 using testing::Return;
 
+// matches the status of a goal by its id
+MATCHER_P(GoalId, id, "")
+{
+  return arg.goal_id.id == id;
+}
+
 TEST_F(AbstractActionBaseFixture, cancelAll)
 {
   // spawn a bunch of threads
@@ -74,9 +180,140 @@ TEST_F(AbstractActionBaseFixture, cancelAll)
   cancelAll();
 
   // check the result
-  for (ConcurrencyMap::iterator slot = concurrency_slots_.begin();
-       slot != concurrency_slots_.end(); ++slot)
-    ASSERT_FALSE(slot->second.in_use);
+  for (size_t slot = 0; slot != concurrency_slots_.size(); ++slot)
+    ASSERT_FALSE(concurrency_slots_[slot].in_use);
+}
+
+TEST_F(AbstractActionBaseFixture, run_pending)
+{
+  // a goal queued on a busy slot runs on the same slot thread, once the current one finishes
+  unsigned char slot = 2;
+  MockedExecution::Ptr pending(new MockedExecution(AbstractActionBaseFixture::ri));
+  concurrency_slots_[slot].execution.reset(new MockedExecution(AbstractActionBaseFixture::ri));
+  concurrency_slots_[slot].pending_execution = pending;
+  concurrency_slots_[slot].has_pending = true;
+  concurrency_slots_[slot].in_use = true;
+
+  run(concurrency_slots_[slot]);
+
+  // the queued execution has been run, and the slot is free again
+  ASSERT_EQ(concurrency_slots_[slot].execution, pending);
+  ASSERT_FALSE(concurrency_slots_[slot].pending_execution);
+  ASSERT_FALSE(concurrency_slots_[slot].has_pending);
+  ASSERT_FALSE(concurrency_slots_[slot].in_use);
+}
+
+TEST_F(AbstractActionBaseFixture, slot_table)
+{
+  // every possible slot id has its own entry, aligned to a cache line so independent slots never share one
+  ASSERT_EQ(concurrency_slots_.size(), 256);
+  ASSERT_EQ(alignof(ConcurrencySlot), 64);
+  for (size_t slot = 0; slot != concurrency_slots_.size(); ++slot)
+  {
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(&concurrency_slots_[slot]) % 64, 0);
+    ASSERT_FALSE(concurrency_slots_[slot].in_use);
+    ASSERT_FALSE(concurrency_slots_[slot].execution);
+  }
+}
+
+TEST_F(AbstractActionBaseFixture, queue_on_busy_slot)
+{
+  // a goal sent to a busy slot gets queued, the running one canceled, and it runs once the running one finishes
+  MockedExecution::Ptr first(new MockedExecution(AbstractActionBaseFixture::ri));
+  MockedExecution::Ptr second(new MockedExecution(AbstractActionBaseFixture::ri));
+  EXPECT_CALL(*first, cancel()).WillOnce(Return(true));
+  EXPECT_CALL(*second, cancel()).Times(0);
+  EXPECT_CALL(action_server_, publishResult(_, _)).Times(0);
+
+  hold_runs_ = true;
+  sendGoal("first", 3, first);
+  waitForRuns(1);
+  sendGoal("second", 3, second);
+
+  {
+    boost::lock_guard<boost::mutex> guard(concurrency_slots_[3].mtx);
+    ASSERT_TRUE(concurrency_slots_[3].in_use);
+    ASSERT_TRUE(concurrency_slots_[3].has_pending);
+    ASSERT_EQ(concurrency_slots_[3].pending_execution, second);
+    ASSERT_EQ(concurrency_slots_[3].pending_goal_handle.getGoalID().id, "second");
+  }
+
+  releaseRuns(3);
+  ASSERT_THAT(run_goals_, ElementsAre("first", "second"));
+  ASSERT_EQ(concurrency_slots_[3].execution, second);
+  ASSERT_FALSE(concurrency_slots_[3].has_pending);
+  ASSERT_FALSE(concurrency_slots_[3].in_use);
+
+  // the action destructor cancels the last executions; that's out of the scope of this test
+  testing::Mock::VerifyAndClearExpectations(first.get());
+  testing::Mock::VerifyAndClearExpectations(second.get());
+}
+
+TEST_F(AbstractActionBaseFixture, replace_queued_goal)
+{
+  // a newer goal replaces the one already queued, which gets canceled without ever running
+  MockedExecution::Ptr first(new MockedExecution(AbstractActionBaseFixture::ri));
+  MockedExecution::Ptr second(new MockedExecution(AbstractActionBaseFixture::ri));
+  MockedExecution::Ptr third(new MockedExecution(AbstractActionBaseFixture::ri));
+  EXPECT_CALL(*first, cancel()).WillRepeatedly(Return(true));
+  EXPECT_CALL(*second, cancel()).Times(0);
+  EXPECT_CALL(*third, cancel()).Times(0);
+  EXPECT_CALL(action_server_, publishResult(_, _)).Times(0);
+  EXPECT_CALL(action_server_, publishResult(
+      GoalId("second"), Field(&mbf_msgs::GetPathResult::outcome, mbf_msgs::GetPathResult::CANCELED))).Times(1);
+
+  hold_runs_ = true;
+  sendGoal("first", 4, first);
+  waitForRuns(1);
+  sendGoal("second", 4, second);
+  sendGoal("third", 4, third);
+
+  {
+    boost::lock_guard<boost::mutex> guard(concurrency_slots_[4].mtx);
+    ASSERT_TRUE(concurrency_slots_[4].has_pending);
+    ASSERT_EQ(concurrency_slots_[4].pending_execution, third);
+  }
+
+  releaseRuns(4);
+  ASSERT_THAT(run_goals_, ElementsAre("first", "third"));
+  ASSERT_FALSE(concurrency_slots_[4].in_use);
+
+  testing::Mock::VerifyAndClearExpectations(first.get());
+  testing::Mock::VerifyAndClearExpectations(second.get());
+  testing::Mock::VerifyAndClearExpectations(third.get());
+}
+
+TEST_F(AbstractActionBaseFixture, cancel_queued_goal)
+{
+  // canceling a queued goal just drops it; the running one is only canceled once, when the goal got queued
+  MockedExecution::Ptr first(new MockedExecution(AbstractActionBaseFixture::ri));
+  MockedExecution::Ptr second(new MockedExecution(AbstractActionBaseFixture::ri));
+  EXPECT_CALL(*first, cancel()).WillOnce(Return(true));
+  EXPECT_CALL(*second, cancel()).Times(0);
+  EXPECT_CALL(action_server_, publishResult(_, _)).Times(0);
+  EXPECT_CALL(action_server_, publishResult(
+      GoalId("second"), Field(&mbf_msgs::GetPathResult::outcome, mbf_msgs::GetPathResult::CANCELED))).Times(1);
+
+  hold_runs_ = true;
+  sendGoal("first", 5, first);
+  waitForRuns(1);
+  sendGoal("second", 5, second);
+  cancelGoal("second");
+
+  {
+    boost::lock_guard<boost::mutex> guard(concurrency_slots_[5].mtx);
+    ASSERT_TRUE(concurrency_slots_[5].in_use);
+    ASSERT_FALSE(concurrency_slots_[5].has_pending);
+    ASSERT_FALSE(concurrency_slots_[5].pending_execution);
+  }
+
+  releaseRuns(5);
+  ASSERT_THAT(run_goals_, ElementsAre("first"));
+  ASSERT_EQ(concurrency_slots_[5].execution, first);
+  ASSERT_FALSE(concurrency_slots_[5].in_use);
+
+  testing::Mock::VerifyAndClearExpectations(first.get());
+  testing::Mock::VerifyAndClearExpectations(second.get());
 }
 
 int main(int argc, char **argv)
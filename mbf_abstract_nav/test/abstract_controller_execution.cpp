@@ -39,6 +39,11 @@ struct AbstractControllerMock : public AbstractController
   MOCK_METHOD2(isGoalReached, bool(double, double));
   MOCK_METHOD1(setPlan, bool(const plan_t&));
   MOCK_METHOD0(cancel, bool());
+
+  // the mocked plan preparation members
+  MOCK_METHOD0(supportsPlanPreparation, bool());
+  MOCK_METHOD1(preparePlan, bool(const plan_t&));
+  MOCK_METHOD0(commitPreparedPlan, bool());
 };
 
 ros::Publisher VEL_PUB;
@@ -292,6 +297,117 @@ TEST_F(FailureFixture, patExceeded)
   ASSERT_EQ(getState(), PAT_EXCEEDED);
 }
 
+TEST_F(FailureFixture, latencyCompensation)
+{
+  // test verifies that the latency compensation measures the plugin computing time and evaluates the predicted
+  // poses given to the plugin. The robot doesn't move here, so the predictions must be exact
+
+  // disable the retries logic and enable the latency compensation
+  max_retries_ = -1;
+  latency_compensation_ = true;
+
+  // call start
+  ASSERT_TRUE(start());
+
+  // the first cycle measures the computing time; the following ones predict the robot pose
+  for (int i = 0; i < 3; ++i)
+  {
+    waitForStateUpdate(boost::chrono::seconds(1));
+    ASSERT_EQ(getState(), NO_LOCAL_CMD);
+  }
+
+  const LatencyCompensationStats stats = getLatencyCompensationStats();
+
+  // stop the controller, as it would otherwise keep retrying forever
+  ASSERT_TRUE(cancel());
+
+  ASSERT_GE(stats.compute_latency, 0.0);
+  ASSERT_GE(stats.samples, 1u);
+  ASSERT_NEAR(stats.mean_dist_error, 0.0, 1e-6);
+  ASSERT_NEAR(stats.mean_angle_error, 0.0, 1e-6);
+}
+
+TEST_F(FailureFixture, planPreparation)
+{
+  // test verifies that, with controllers supporting it, new plans are prepared on a side thread and committed
+  // on the control loop, while the controller keeps running with the current plan
+
+  // the first plan is set right away (expectation set on the fixture); the second one is prepared
+  AbstractControllerMock& mock = dynamic_cast<AbstractControllerMock&>(*controller_);
+  EXPECT_CALL(mock, supportsPlanPreparation()).WillRepeatedly(Return(true));
+  EXPECT_CALL(mock, preparePlan(_)).WillOnce(Return(true));
+  EXPECT_CALL(mock, commitPreparedPlan()).WillOnce(Return(true));
+
+  // disable the retries logic
+  max_retries_ = -1;
+
+  // call start
+  ASSERT_TRUE(start());
+  waitForStateUpdate(boost::chrono::seconds(1));
+  ASSERT_EQ(getState(), NO_LOCAL_CMD);
+
+  // send a new plan; the control loop keeps running meanwhile
+  plan_t plan(10);
+  setNewPlan(plan, true, 1e-3, 1e-3);
+  for (int i = 0; i < 10; ++i)
+  {
+    waitForStateUpdate(boost::chrono::seconds(1));
+    ASSERT_EQ(getState(), NO_LOCAL_CMD);
+  }
+
+  // stop the controller, as it would otherwise keep retrying forever
+  ASSERT_TRUE(cancel());
+}
+
+ACTION(SlowControllerFailure)
+{
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(20));
+  return 11;
+}
+
+TEST_F(FailureFixture, governor)
+{
+  // test verifies that the governor lowers the loop rate when the controller cannot keep up with it, and reports
+  // the degraded health. The plugin takes 20 ms, so at 100 Hz the utilization exceeds the allowed 50 %
+  AbstractControllerMock& mock = dynamic_cast<AbstractControllerMock&>(*controller_);
+  EXPECT_CALL(mock, computeVelocityCommands(_, _, _, _)).WillRepeatedly(SlowControllerFailure());
+
+  MoveBaseFlexConfig config;
+  config.controller_frequency = 100;
+  config.controller_min_frequency = 10;
+  config.controller_max_utilization = 0.5;
+  config.controller_max_retries = -1;
+  reconfigure(config);
+  ASSERT_EQ(getHealth().level, diagnostic_msgs::DiagnosticStatus::OK);
+
+  // call start
+  ASSERT_TRUE(start());
+
+  // after a full window of plugin calls, the governor lowers the rate to about 25 Hz
+  for (int i = 0; i < 25; ++i)
+  {
+    waitForStateUpdate(boost::chrono::seconds(1));
+  }
+
+  const diagnostic_msgs::DiagnosticStatus health = getHealth();
+
+  // stop the controller, as it would otherwise keep retrying forever
+  ASSERT_TRUE(cancel());
+
+  ASSERT_EQ(health.level, diagnostic_msgs::DiagnosticStatus::WARN);
+  ASSERT_EQ(health.values[0].key, "frequency");
+  ASSERT_LT(std::stod(health.values[0].value), 100.0);
+  ASSERT_GE(std::stod(health.values[0].value), 10.0);
+
+  // resetting the execution for the next goal restores the configured rate and forgets about the previous goal
+  reset();
+  ASSERT_EQ(getHealth().level, diagnostic_msgs::DiagnosticStatus::OK);
+  ASSERT_TRUE(getHealth().values.empty());
+  ASSERT_EQ(frequency_, 100.0);
+  ASSERT_TRUE(getLastPluginCallTime().isZero());
+  ASSERT_TRUE(getVelocityCmd().header.stamp.isZero());
+}
+
 int main(int argc, char** argv)
 {
   ros::init(argc, argv, "read_types");
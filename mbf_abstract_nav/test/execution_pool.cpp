@@ -0,0 +1,224 @@
+#include <gtest/gtest.h>
+#include <mbf_abstract_nav/abstract_execution_base.h>
+#include <mbf_abstract_nav/execution_pool.hpp>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+using namespace mbf_abstract_nav;
+
+// a dummy execution with some storage reserved, as real executions have for their plans
+struct DummyExecution : public AbstractExecutionBase
+{
+  typedef boost::shared_ptr<DummyExecution> Ptr;
+
+  static int alive;
+
+  DummyExecution(const std::string& _name, const mbf_utility::RobotInformation& ri)
+    : AbstractExecutionBase(_name, ri), resets(0), reconfigurations(0)
+  {
+    plan.reserve(1000);
+    ++alive;
+  }
+
+  ~DummyExecution()
+  {
+    --alive;
+  }
+
+  void reset()
+  {
+    AbstractExecutionBase::reset();
+    plan.clear();
+    ++resets;
+  }
+
+  void reconfigure(const MoveBaseFlexConfig& config)
+  {
+    ++reconfigurations;
+  }
+
+  // runs until told to finish
+  void run()
+  {
+    boost::unique_lock<boost::mutex> lock(run_mtx);
+    while (!finish)
+      run_cv.wait(lock);
+  }
+
+  void finishRun()
+  {
+    boost::lock_guard<boost::mutex> guard(run_mtx);
+    finish = true;
+    run_cv.notify_all();
+  }
+
+  std::vector<geometry_msgs::PoseStamped> plan;
+  int resets;
+  int reconfigurations;
+
+  boost::mutex run_mtx;
+  boost::condition_variable run_cv;
+  bool finish = false;
+};
+
+int DummyExecution::alive = 0;
+
+// shortcuts...
+using testing::Test;
+
+struct ExecutionPoolFixture : public Test
+{
+  TF tf_;
+  mbf_utility::RobotInformation ri_;
+  MoveBaseFlexConfig config_;
+  ExecutionPool<DummyExecution> pool_;
+
+  ExecutionPoolFixture() : ri_(tf_, "global_frame", "local_frame", ros::Duration(), ""), pool_(2)
+  {
+  }
+
+  DummyExecution::Ptr newExecution(const std::string& name)
+  {
+    return boost::make_shared<DummyExecution>(name, ri_);
+  }
+
+  DummyExecution::Ptr acquire(const std::string& name)
+  {
+    return pool_.acquire(name, boost::bind(&ExecutionPoolFixture::newExecution, this, name), config_);
+  }
+};
+
+TEST_F(ExecutionPoolFixture, reuse_after_release)
+{
+  DummyExecution::Ptr execution = acquire("foo");
+  DummyExecution* raw = execution.get();
+  execution.reset();
+  EXPECT_EQ(pool_.getIdleCount("foo"), 1);
+
+  // we get the same object back, reset and reconfigured
+  execution = acquire("foo");
+  EXPECT_EQ(execution.get(), raw);
+  EXPECT_EQ(execution->resets, 1);
+  EXPECT_EQ(execution->reconfigurations, 1);
+  EXPECT_EQ(pool_.getCreatedCount(), 1);
+  EXPECT_EQ(pool_.getReusedCount(), 1);
+  EXPECT_EQ(pool_.getIdleCount("foo"), 0);
+}
+
+TEST_F(ExecutionPoolFixture, per_plugin)
+{
+  // executions are not shared among plugins
+  acquire("foo");
+  DummyExecution::Ptr execution = acquire("bar");
+  EXPECT_EQ(execution->getName(), "bar");
+  EXPECT_EQ(pool_.getCreatedCount(), 2);
+}
+
+TEST_F(ExecutionPoolFixture, in_use)
+{
+  // executions in use are not handed out again
+  DummyExecution::Ptr execution_1 = acquire("foo");
+  DummyExecution::Ptr execution_2 = acquire("foo");
+  EXPECT_NE(execution_1.get(), execution_2.get());
+  EXPECT_EQ(pool_.getCreatedCount(), 2);
+}
+
+TEST_F(ExecutionPoolFixture, max_idle)
+{
+  // we keep up to 2 idle executions per plugin; the rest get deleted
+  const int alive_before = DummyExecution::alive;
+  {
+    std::vector<DummyExecution::Ptr> executions;
+    for (size_t ii = 0; ii != 5; ++ii)
+      executions.push_back(acquire("foo"));
+  }
+  EXPECT_EQ(pool_.getIdleCount("foo"), 2);
+  EXPECT_EQ(DummyExecution::alive, alive_before + 2);
+
+  pool_.clear();
+  EXPECT_EQ(pool_.getIdleCount("foo"), 0);
+  EXPECT_EQ(DummyExecution::alive, alive_before);
+}
+
+TEST_F(ExecutionPoolFixture, outlive_pool)
+{
+  // executions released after the pool is gone just get deleted
+  const int alive_before = DummyExecution::alive;
+  DummyExecution::Ptr execution;
+  {
+    ExecutionPool<DummyExecution> pool;
+    execution = pool.acquire("foo", boost::bind(&ExecutionPoolFixture::newExecution, this, "foo"), config_);
+  }
+  EXPECT_EQ(DummyExecution::alive, alive_before + 1);
+  execution.reset();
+  EXPECT_EQ(DummyExecution::alive, alive_before);
+}
+
+TEST_F(ExecutionPoolFixture, release_running)
+{
+  // an execution released while still running is not handed out again until it finishes, and neither releasing it
+  // nor acquiring a new one waits for it
+  DummyExecution::Ptr execution = acquire("foo");
+  DummyExecution* raw = execution.get();
+  ASSERT_TRUE(execution->start());
+  execution.reset();
+  EXPECT_EQ(pool_.getIdleCount("foo"), 0);
+
+  DummyExecution::Ptr other = acquire("foo");
+  EXPECT_NE(other.get(), raw);
+  EXPECT_EQ(pool_.getCreatedCount(), 2);
+
+  // once finished, it's given back to the pool
+  raw->finishRun();
+  for (int ii = 0; ii != 100 && pool_.getIdleCount("foo") == 0; ++ii)
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+  ASSERT_EQ(pool_.getIdleCount("foo"), 1);
+
+  execution = acquire("foo");
+  EXPECT_EQ(execution.get(), raw);
+  EXPECT_EQ(pool_.getReusedCount(), 1);
+}
+
+TEST_F(ExecutionPoolFixture, goal_stream_benchmark)
+{
+  // simulate a stream of goals on a single concurrency slot, as we get with continuous replanning: every new goal
+  // replaces the execution of the previous one. Compare pooling with creating a new execution for every goal
+  const size_t goals = 100;
+  DummyExecution::Ptr slot;
+
+  size_t created = 0;
+  boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  for (size_t ii = 0; ii != goals; ++ii)
+  {
+    slot = newExecution("foo");
+    ++created;
+  }
+  const boost::chrono::nanoseconds unpooled = boost::chrono::steady_clock::now() - start;
+  slot.reset();
+
+  start = boost::chrono::steady_clock::now();
+  for (size_t ii = 0; ii != goals; ++ii)
+  {
+    slot = acquire("foo");
+  }
+  const boost::chrono::nanoseconds pooled = boost::chrono::steady_clock::now() - start;
+
+  RecordProperty("unpooled_accept_ns", boost::lexical_cast<std::string>(unpooled.count() / goals));
+  RecordProperty("pooled_accept_ns", boost::lexical_cast<std::string>(pooled.count() / goals));
+  RecordProperty("unpooled_allocations", boost::lexical_cast<std::string>(created));
+  RecordProperty("pooled_allocations", boost::lexical_cast<std::string>(pool_.getCreatedCount()));
+
+  // the new execution is acquired before the previous one is released, so we need two of them
+  EXPECT_EQ(pool_.getCreatedCount(), 2);
+  EXPECT_EQ(pool_.getReusedCount(), goals - 2);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
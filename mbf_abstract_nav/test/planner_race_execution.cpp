@@ -0,0 +1,212 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+
+#include <mbf_abstract_core/abstract_planner.h>
+#include <mbf_abstract_nav/planner_race_execution.h>
+
+// too long namespaces...
+using geometry_msgs::PoseStamped;
+using mbf_abstract_core::AbstractPlanner;
+
+// mocked version of a planner
+// we will control the output of it
+struct AbstractPlannerMock : public AbstractPlanner
+{
+  MOCK_METHOD6(makePlan, uint32_t(const PoseStamped&, const PoseStamped&, double, std::vector<PoseStamped>&, double&,
+                                  std::string&));
+
+  MOCK_METHOD0(cancel, bool());
+};
+
+using mbf_abstract_nav::AbstractPlannerExecution;
+using mbf_abstract_nav::PlannerRaceExecution;
+using mbf_abstract_nav::MoveBaseFlexConfig;
+using testing::_;
+using testing::DoAll;
+using testing::Invoke;
+using testing::Return;
+using testing::SetArgReferee;
+using testing::Test;
+
+TFPtr TF_PTR;
+mbf_utility::RobotInformation::Ptr ROBOT_INFO_PTR;
+
+ACTION_P(Wait, cv)
+{
+  boost::mutex m;
+  boost::unique_lock<boost::mutex> lock(m);
+  cv->wait(lock);
+  return 11;
+}
+
+// setup the test-fixture: a race between a fast and a slow planner
+struct PlannerRaceExecutionFixture : public Test
+{
+  PoseStamped pose;  // dummy pose to call start
+  std::vector<PoseStamped> plan;  // dummy plan returned by the planners
+  boost::condition_variable cv;  // keeps the slow planner busy
+
+  boost::shared_ptr<AbstractPlannerMock> fast_planner;
+  boost::shared_ptr<AbstractPlannerMock> slow_planner;
+  std::vector<AbstractPlannerExecution::Ptr> contenders;
+  PlannerRaceExecution::Ptr race;
+
+  PlannerRaceExecutionFixture()
+    : plan(2), fast_planner(new AbstractPlannerMock()), slow_planner(new AbstractPlannerMock())
+  {
+    contenders.push_back(boost::make_shared<AbstractPlannerExecution>("fast", fast_planner, *ROBOT_INFO_PTR,
+                                                                      MoveBaseFlexConfig{}));
+    contenders.push_back(boost::make_shared<AbstractPlannerExecution>("slow", slow_planner, *ROBOT_INFO_PTR,
+                                                                      MoveBaseFlexConfig{}));
+  }
+
+  void runRace(PlannerRaceExecution::RaceMode mode, double deadline)
+  {
+    AbstractPlannerExecution::Settings::ConstPtr settings = boost::make_shared<AbstractPlannerExecution::Settings>();
+    race = boost::make_shared<PlannerRaceExecution>("race", contenders, mode, ros::Duration(deadline),
+                                                    *ROBOT_INFO_PTR, settings, MoveBaseFlexConfig{});
+    ASSERT_TRUE(race->start(pose, pose, 0));
+
+    // the race thread finishes once the race is decided
+    race->join();
+  }
+
+  void TearDown() override
+  {
+    // release the slow planner, so its thread can be joined
+    cv.notify_all();
+  }
+};
+
+TEST_F(PlannerRaceExecutionFixture, first_plan_wins)
+{
+  // the fast planner wins, and the slow one gets canceled
+  EXPECT_CALL(*fast_planner, makePlan(_, _, _, _, _, _))
+      .WillOnce(DoAll(SetArgReferee<3>(plan), SetArgReferee<4>(5.0), Return(0)));
+  // makePlan may or may not be called
+  ON_CALL(*slow_planner, makePlan(_, _, _, _, _, _)).WillByDefault(Wait(&cv));
+  EXPECT_CALL(*slow_planner, cancel()).Times(1).WillOnce(Return(true));
+
+  runRace(PlannerRaceExecution::FIRST, 0);
+
+  ASSERT_EQ(race->getState(), AbstractPlannerExecution::FOUND_PLAN);
+  ASSERT_EQ(race->getWinner(), "fast");
+  ASSERT_EQ(race->getCost(), 5.0);
+}
+
+TEST_F(PlannerRaceExecutionFixture, best_plan_wins)
+{
+  // both planners finish, and the cheapest plan wins
+  EXPECT_CALL(*fast_planner, makePlan(_, _, _, _, _, _))
+      .WillOnce(DoAll(SetArgReferee<3>(plan), SetArgReferee<4>(5.0), Return(0)));
+  EXPECT_CALL(*slow_planner, makePlan(_, _, _, _, _, _))
+      .WillOnce(DoAll(SetArgReferee<3>(plan), SetArgReferee<4>(2.0), Return(0)));
+
+  runRace(PlannerRaceExecution::BEST, 0);
+
+  ASSERT_EQ(race->getState(), AbstractPlannerExecution::FOUND_PLAN);
+  ASSERT_EQ(race->getWinner(), "slow");
+  ASSERT_EQ(race->getCost(), 2.0);
+}
+
+TEST_F(PlannerRaceExecutionFixture, deadline_expired)
+{
+  // the slow planner doesn't finish before the deadline, so the best plan found so far wins
+  EXPECT_CALL(*fast_planner, makePlan(_, _, _, _, _, _))
+      .WillOnce(DoAll(SetArgReferee<3>(plan), SetArgReferee<4>(5.0), Return(0)));
+  ON_CALL(*slow_planner, makePlan(_, _, _, _, _, _)).WillByDefault(Wait(&cv));
+  EXPECT_CALL(*slow_planner, cancel()).Times(1).WillOnce(Return(true));
+
+  runRace(PlannerRaceExecution::BEST, 0.1);
+
+  ASSERT_EQ(race->getState(), AbstractPlannerExecution::FOUND_PLAN);
+  ASSERT_EQ(race->getWinner(), "fast");
+}
+
+TEST_F(PlannerRaceExecutionFixture, no_plan_found)
+{
+  // no planner finds a plan, so nobody wins
+  EXPECT_CALL(*fast_planner, makePlan(_, _, _, _, _, _)).WillOnce(Return(11));
+  EXPECT_CALL(*slow_planner, makePlan(_, _, _, _, _, _)).WillOnce(Return(11));
+
+  runRace(PlannerRaceExecution::FIRST, 0);
+
+  ASSERT_EQ(race->getState(), AbstractPlannerExecution::NO_PLAN_FOUND);
+  ASSERT_TRUE(race->getWinner().empty());
+}
+
+TEST_F(PlannerRaceExecutionFixture, consecutive_races)
+{
+  // the slow planner loses the first race and gets canceled, but it must compete normally on the next one
+  bool first_race = true;
+  EXPECT_CALL(*fast_planner, makePlan(_, _, _, _, _, _))
+      .WillOnce(DoAll(SetArgReferee<3>(plan), SetArgReferee<4>(5.0), Return(0)))
+      .WillOnce(Return(11));
+  EXPECT_CALL(*slow_planner, makePlan(_, _, _, _, _, _))
+      .WillRepeatedly(Invoke([&](const PoseStamped&, const PoseStamped&, double, std::vector<PoseStamped>& result,
+                                 double& cost, std::string&) {
+        if (first_race)
+          ros::WallDuration(0.1).sleep();
+        result = plan;
+        cost = 2.0;
+        return 0u;
+      }));
+  EXPECT_CALL(*slow_planner, cancel()).WillRepeatedly(Return(true));
+
+  runRace(PlannerRaceExecution::FIRST, 0);
+
+  ASSERT_EQ(race->getState(), AbstractPlannerExecution::FOUND_PLAN);
+  ASSERT_EQ(race->getWinner(), "fast");
+
+  // wait for the canceled slow planner to finish, and race again
+  contenders[1]->join();
+  first_race = false;
+  ASSERT_TRUE(race->start(pose, pose, 0));
+  race->join();
+
+  ASSERT_EQ(race->getState(), AbstractPlannerExecution::FOUND_PLAN);
+  ASSERT_EQ(race->getWinner(), "slow");
+  ASSERT_EQ(race->getCost(), 2.0);
+}
+
+TEST_F(PlannerRaceExecutionFixture, cancel_busy_contenders)
+{
+  // the planners ignore cancel, but the race itself stops waiting for them right away
+  ON_CALL(*fast_planner, makePlan(_, _, _, _, _, _)).WillByDefault(Wait(&cv));
+  ON_CALL(*slow_planner, makePlan(_, _, _, _, _, _)).WillByDefault(Wait(&cv));
+  EXPECT_CALL(*fast_planner, cancel()).WillRepeatedly(Return(false));
+  EXPECT_CALL(*slow_planner, cancel()).WillRepeatedly(Return(false));
+
+  AbstractPlannerExecution::Settings::ConstPtr settings = boost::make_shared<AbstractPlannerExecution::Settings>();
+  race = boost::make_shared<PlannerRaceExecution>("race", contenders, PlannerRaceExecution::FIRST, ros::Duration(0),
+                                                  *ROBOT_INFO_PTR, settings, MoveBaseFlexConfig{});
+  ASSERT_TRUE(race->start(pose, pose, 0));
+  ros::WallDuration(0.1).sleep();
+
+  ASSERT_FALSE(race->cancel());
+  race->join();
+
+  ASSERT_EQ(race->getState(), AbstractPlannerExecution::CANCELED);
+  ASSERT_TRUE(race->getWinner().empty());
+}
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "read_types");
+  ros::NodeHandle nh;
+
+  // setup the tf-publisher and robot info as a global objects
+  TF_PTR.reset(new TF());
+  TF_PTR->setUsingDedicatedThread(true);
+  ros::Duration TF_TIMEOUT(1.0);
+  ROBOT_INFO_PTR.reset(new mbf_utility::RobotInformation(*TF_PTR, "global_frame", "robot_frame", TF_TIMEOUT, ""));
+
+  // suppress the logging since we don't want warnings to pollute the test-outcome
+  if (ros::console::set_logger_level(ROSCONSOLE_DEFAULT_NAME, ros::console::levels::Fatal))
+  {
+    ros::console::notifyLoggerLevelsChanged();
+  }
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -92,6 +92,38 @@ namespace mbf_costmap_core {
        */
       virtual bool cancel() = 0;
 
+      /**
+       * @brief Whether the planner can plan on a snapshot of the costmap, with makePlanOnSnapshot. If so, MBF will
+       * use it instead of makePlan, so the costmap keeps updating while planning.
+       * @remark New on MBF API
+       * @return True if makePlanOnSnapshot is implemented; false by default
+       */
+      virtual bool supportsSnapshots() const { return false; }
+
+      /**
+       * @brief Given a goal pose in the world, compute a plan on the given costmap snapshot, instead of on the costmap
+       * provided on initialization. The snapshot is immutable and is not locked while planning.
+       * @remark New on MBF API
+       * @param start The start pose
+       * @param goal The goal pose
+       * @param tolerance If the goal is obstructed, how many meters the planner can relax the constraint
+       *        in x and y before failing
+       * @param costmap Snapshot of the costmap to plan on, on the same frame as the one provided on initialization;
+       *        it can cover just a region of it, containing start and goal, so don't assume the same origin and size
+       * @param plan The plan... filled by the planner
+       * @param cost The cost for the the plan
+       * @param message Optional more detailed outcome as a string
+       * @return Result code as described on makePlan; by default, it plans with makePlan on the live costmap
+       */
+      virtual uint32_t makePlanOnSnapshot(const geometry_msgs::PoseStamped &start,
+                                          const geometry_msgs::PoseStamped &goal, double tolerance,
+                                          const costmap_2d::Costmap2D &costmap,
+                                          std::vector<geometry_msgs::PoseStamped> &plan, double &cost,
+                                          std::string &message)
+      {
+        return makePlan(start, goal, tolerance, plan, cost, message);
+      }
+
       /**
        * @brief Initialization function for the CostmapPlanner
        * @param name The name of this planner
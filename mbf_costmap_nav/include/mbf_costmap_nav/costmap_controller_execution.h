@@ -61,6 +61,46 @@ class CostmapControllerExecution : public mbf_abstract_nav::AbstractControllerEx
 {
 public:
 
+  /**
+   * @brief Static parameters of the costmap controller executions, on top of the abstract ones.
+   */
+  struct Settings : public mbf_abstract_nav::AbstractControllerExecution::Settings
+  {
+    typedef boost::shared_ptr<const Settings> ConstPtr;
+
+    /**
+     * @brief Reads the settings from the parameter server.
+     * @param private_nh Node handle on the namespace of the navigation server
+     */
+    void loadParams(const ros::NodeHandle &private_nh);
+
+    /**
+     * @brief Creates the settings with the values from the parameter server.
+     * @param private_nh Node handle on the namespace of the navigation server
+     * @return Shared pointer to the new settings
+     */
+    static ConstPtr load(const ros::NodeHandle &private_nh);
+
+    bool lock_costmap;
+  };
+
+  /**
+   * @brief Constructor; reads the static parameters from the parameter server.
+   * @param controller_name Name of the controller to use.
+   * @param controller_ptr Shared pointer to the plugin to use.
+   * @param robot_info Current robot state
+   * @param vel_pub Velocity commands publisher.
+   * @param costmap_ptr Shared pointer to the local costmap.
+   * @param config Current server configuration (dynamic).
+   */
+  CostmapControllerExecution(
+      const std::string &controller_name,
+      const mbf_costmap_core::CostmapController::Ptr &controller_ptr,
+      const mbf_utility::RobotInformation &robot_info,
+      const ros::Publisher &vel_pub,
+      const CostmapWrapper::Ptr &costmap_ptr,
+      const MoveBaseFlexConfig &config);
+
   /**
    * @brief Constructor.
    * @param controller_name Name of the controller to use.
@@ -68,6 +108,7 @@ public:
    * @param robot_info Current robot state
    * @param vel_pub Velocity commands publisher.
    * @param costmap_ptr Shared pointer to the local costmap.
+   * @param settings Static parameters, shared by all the executions.
    * @param config Current server configuration (dynamic).
    */
   CostmapControllerExecution(
@@ -76,6 +117,7 @@ public:
       const mbf_utility::RobotInformation &robot_info,
       const ros::Publisher &vel_pub,
       const CostmapWrapper::Ptr &costmap_ptr,
+      const Settings::ConstPtr &settings,
       const MoveBaseFlexConfig &config);
 
   /**
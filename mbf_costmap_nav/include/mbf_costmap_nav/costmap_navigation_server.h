@@ -183,15 +183,17 @@ private:
                                         const mbf_abstract_core::AbstractRecovery::Ptr& behavior_ptr);
 
   /**
-   * @brief If mbf_msgs::CheckPose::Request::LOCAL_COSTMAP the local costmap is returned
+   * @brief If a costmap name is given, the costmap with that name is returned. Otherwise, if
+   * mbf_msgs::CheckPose::Request::LOCAL_COSTMAP the local costmap is returned
    * if mbf_msgs::CheckPose::Request::GLOBAL_COSTMAP, the global costmap is returned.
    * Otherwise, it returns an empty pointer.
    * @param costmap_type The type of the costmap to return
-   * @return A pair: string which is the type of the costmap; and the shared pointer to the requested costmap.
+   * @param costmap_name The name of the costmap to return; if not empty, it prevails over costmap_type
+   * @return A pair: string which is the name of the costmap; and the shared pointer to the requested costmap.
    * If costmap is not valid, it returns an empty pointer and an empty string.
    */
   std::pair<std::string, CostmapWrapper::Ptr>
-  requestedCostmap(mbf_msgs::CheckPose::Request::_costmap_type costmap_type) const;
+  requestedCostmap(mbf_msgs::CheckPose::Request::_costmap_type costmap_type, const std::string& costmap_name) const;
 
   /**
    * @brief Callback method for the check_point_cost service
@@ -241,6 +243,22 @@ private:
    */
   bool callServiceUpdateCostmaps(std_srvs::Empty::Request& request, std_srvs::Empty::Response& response);
 
+  /**
+   * @brief Callback method for the prewarm_costmaps service; starts all costmaps on the background if they are
+   * shut down, so they are ready for the actions to come. Returns immediately.
+   * @param request Empty request object.
+   * @param response Empty response object.
+   * @return true, if the service completed successfully, false otherwise
+   */
+  bool callServicePrewarmCostmaps(std_srvs::Empty::Request& request, std_srvs::Empty::Response& response);
+
+  /**
+   * @brief MoveBase action execution method. Pre-warms both costmaps, so the controller doesn't wait for the local
+   * costmap to start once the plan is ready, and then starts the action as the abstract server does.
+   * @param goal_handle Goal handle of the received move_base goal.
+   */
+  virtual void callActionMoveBase(mbf_abstract_nav::ActionServerMoveBase::GoalHandle goal_handle);
+
   /**
    * @brief Reconfiguration method called by dynamic reconfigure.
    * @param config Configuration parameters. See the MoveBaseFlexConfig definition.
@@ -273,12 +291,21 @@ private:
   //! Shared pointer to the common global costmap
   const CostmapWrapper::Ptr global_costmap_ptr_;
 
+  //! All costmaps by name: local_costmap, global_costmap and the additional ones listed on the costmaps parameter
+  StringToMap costmaps_;
+
   //! Maps planner names to the costmap ptr.
   StringToMap planner_name_to_costmap_ptr_;
 
   //! Maps the controller names to the costmap ptr.
   StringToMap controller_name_to_costmap_ptr_;
 
+  //! Static parameters of the costmap planner executions, read once on startup
+  CostmapPlannerExecution::Settings::ConstPtr costmap_planner_settings_;
+
+  //! Static parameters of the costmap controller executions, read once on startup
+  CostmapControllerExecution::Settings::ConstPtr costmap_controller_settings_;
+
   //! Service Server for the check_point_cost service
   ros::ServiceServer check_point_cost_srv_;
 
@@ -297,6 +324,9 @@ private:
   //! Service Server for the update_costmap service
   ros::ServiceServer update_costmaps_srv_;
 
+  //! Service Server for the prewarm_costmaps service
+  ros::ServiceServer prewarm_costmaps_srv_;
+
   static constexpr double ANGLE_INCREMENT = 5.0 * M_PI / 180.0;  // 5 degrees
 };
 
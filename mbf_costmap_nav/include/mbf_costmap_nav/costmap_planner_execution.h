@@ -60,18 +60,59 @@ namespace mbf_costmap_nav
 class CostmapPlannerExecution : public mbf_abstract_nav::AbstractPlannerExecution
 {
 public:
+  /**
+   * @brief Static parameters of the costmap planner executions, on top of the abstract ones.
+   */
+  struct Settings : public mbf_abstract_nav::AbstractPlannerExecution::Settings
+  {
+    typedef boost::shared_ptr<const Settings> ConstPtr;
+
+    /**
+     * @brief Reads the settings from the parameter server.
+     * @param private_nh Node handle on the namespace of the navigation server
+     */
+    void loadParams(const ros::NodeHandle& private_nh);
+
+    /**
+     * @brief Creates the settings with the values from the parameter server.
+     * @param private_nh Node handle on the namespace of the navigation server
+     * @return Shared pointer to the new settings
+     */
+    static ConstPtr load(const ros::NodeHandle& private_nh);
+
+    bool lock_costmap;
+    bool use_snapshots;
+    double snapshot_region_margin;
+  };
+
+  /**
+   * @brief Constructor; reads the static parameters from the parameter server.
+   * @param planner_name Name of the planner to use.
+   * @param planner_ptr Shared pointer to the plugin to use.
+   * @param robot_info Current robot state
+   * @param costmap_ptr Shared pointer to the global costmap.
+   * @param config Current server configuration (dynamic).
+   */
+  CostmapPlannerExecution(const std::string& planner_name,
+                          const mbf_costmap_core::CostmapPlanner::Ptr& planner_ptr,
+                          const mbf_utility::RobotInformation& robot_info,
+                          const CostmapWrapper::Ptr& costmap_ptr,
+                          const MoveBaseFlexConfig& config);
+
   /**
    * @brief Constructor.
    * @param planner_name Name of the planner to use.
    * @param planner_ptr Shared pointer to the plugin to use.
    * @param robot_info Current robot state
    * @param costmap_ptr Shared pointer to the global costmap.
+   * @param settings Static parameters, shared by all the executions.
    * @param config Current server configuration (dynamic).
    */
   CostmapPlannerExecution(const std::string& planner_name,
                           const mbf_costmap_core::CostmapPlanner::Ptr& planner_ptr,
                           const mbf_utility::RobotInformation& robot_info,
                           const CostmapWrapper::Ptr& costmap_ptr,
+                          const Settings::ConstPtr& settings,
                           const MoveBaseFlexConfig& config);
 
   /**
@@ -123,9 +164,18 @@ private:
   //! Shared pointer to the global planner costmap
   const CostmapWrapper::Ptr &costmap_ptr_;
 
+  //! Shared pointer to the planner plugin, as a costmap planner
+  const mbf_costmap_core::CostmapPlanner::Ptr costmap_planner_;
+
   //! Whether to lock costmap before calling the planner (see issue #4 for details)
   bool lock_costmap_;
 
+  //! Whether to plan on a costmap snapshot, if the planner supports it, so the costmap keeps updating meanwhile
+  bool use_snapshots_;
+
+  //! If positive, snapshot just the bounding box of start and goal, enlarged by this margin, instead of the costmap
+  double snapshot_region_margin_;
+
   //! Name of the planner assigned by the class loader
   std::string planner_name_;
 };
@@ -0,0 +1,110 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  costmap_snapshots.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_COSTMAP_NAV__COSTMAP_SNAPSHOTS_H_
+#define MBF_COSTMAP_NAV__COSTMAP_SNAPSHOTS_H_
+
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/layered_costmap.h>
+
+#include "mbf_costmap_nav/dirty_bounds_layer.h"
+
+
+namespace mbf_costmap_nav
+{
+
+/**
+ * @brief Takes immutable snapshots of a layered costmap, so they can be used for a long time (e.g. for planning)
+ * without blocking the costmap updates. It adds a DirtyBoundsLayer to the costmap, so snapshots are brought up to
+ * date copying just the cells updated since the last one.
+ *
+ * @ingroup move_base_server
+ */
+class CostmapSnapshots
+{
+public:
+  //! Immutable copy of the costmap
+  typedef boost::shared_ptr<const costmap_2d::Costmap2D> SnapshotPtr;
+
+  /**
+   * @brief Constructor. Adds the dirty bounds layer as the last layer of the costmap, so it gets the final update
+   * bounds; construct it once all the other layers are in place. The costmap is locked meanwhile, so it can be
+   * already updating.
+   * @param layered_costmap The costmap to take snapshots of
+   * @param name Name of the dirty bounds layer
+   * @param tf TF buffer for the dirty bounds layer; it doesn't use it
+   */
+  CostmapSnapshots(costmap_2d::LayeredCostmap &layered_costmap, const std::string &name, tf2_ros::Buffer *tf);
+
+  /**
+   * @brief Gets an immutable snapshot of the costmap. Snapshots are copy-on-write: while nobody holds the last one,
+   * it's brought up to date copying only the cells updated since it was taken, so the costmap lock is held for a
+   * time proportional to the changed region. Otherwise, we copy the last snapshot first, without locking the costmap.
+   * @return Shared pointer to the snapshot; keep it for as long as you use it
+   */
+  SnapshotPtr getSnapshot();
+
+  /**
+   * @brief Gets an immutable snapshot of a region of the costmap, e.g. the corridor between start and goal of a plan.
+   * The costmap lock is held for a time proportional to the region area. The region is cropped to the costmap bounds
+   * and extended to whole cells, so the snapshot cells match the costmap ones and include those of the corners.
+   * @param min_x Minimum x coordinate of the region, on the costmap global frame
+   * @param min_y Minimum y coordinate of the region, on the costmap global frame
+   * @param max_x Maximum x coordinate of the region, on the costmap global frame
+   * @param max_y Maximum y coordinate of the region, on the costmap global frame
+   * @return Shared pointer to the snapshot, or an empty pointer if the region is outside the costmap
+   */
+  SnapshotPtr getRegionSnapshot(double min_x, double min_y, double max_x, double max_y);
+
+private:
+  costmap_2d::Costmap2D &costmap_;                          //!< master grid of the costmap
+  boost::shared_ptr<DirtyBoundsLayer> dirty_bounds_layer_;  //!< tracks the cells updated since the last snapshot
+  boost::shared_ptr<costmap_2d::Costmap2D> snapshot_;        //!< last snapshot taken
+  boost::mutex snapshot_mutex_;                              //!< serializes concurrent snapshot requests
+};
+
+} /* namespace mbf_costmap_nav */
+
+#endif /* MBF_COSTMAP_NAV__COSTMAP_SNAPSHOTS_H_ */
@@ -41,10 +41,21 @@
 #ifndef MBF_COSTMAP_NAV__COSTMAP_WRAPPER_H_
 #define MBF_COSTMAP_NAV__COSTMAP_WRAPPER_H_
 
+#include <map>
+#include <set>
+#include <string>
+
+#include <sys/types.h>
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread.hpp>
+
 #include <costmap_2d/costmap_2d_ros.h>
 
 #include <mbf_utility/types.h>
 
+#include "mbf_costmap_nav/costmap_snapshots.h"
+
 
 namespace mbf_costmap_nav
 {
@@ -54,17 +65,68 @@ namespace mbf_costmap_nav
  */
 
 
+/**
+ * @brief Lists the threads of the process on construction. As a base class constructed right before Costmap2DROS,
+ * it lets us identify the threads Costmap2DROS spawns, i.e. its map update thread, to account their CPU usage.
+ * Linux only; elsewhere, no threads are listed.
+ */
+class ThreadSnapshot
+{
+protected:
+  ThreadSnapshot();
+
+  /**
+   * @brief Lists the ids of the threads of the process.
+   */
+  static std::set<pid_t> listThreads();
+
+  //! Thread details from /proc
+  struct ThreadInfo
+  {
+    std::string name;               //!< thread name; unnamed threads inherit the process name
+    unsigned long long start_time;  //!< start time, in clock ticks after boot; tells apart threads reusing a tid
+    double cpu_time;                //!< CPU time in seconds, user plus system
+  };
+
+  /**
+   * @brief Reads the details of a thread of the process.
+   * @param tid Id of the thread
+   * @param info The thread details
+   * @return false if not available, e.g. the thread is gone
+   */
+  static bool readThreadInfo(pid_t tid, ThreadInfo &info);
+
+  //! threads of the process on construction
+  std::set<pid_t> threads_before_;
+};
+
 /**
  * @brief The CostmapWrapper class manages access to a costmap by locking/unlocking its mutex and handles
- * (de)activation.
+ * (de)activation. The shutdown policy can be set for each costmap with the shutdown_costmap and
+ * shutdown_costmap_delay parameters on its namespace; otherwise, it follows the server-wide shutdown_costmaps and
+ * shutdown_costmaps_delay dynamic parameters.
  *
  * @ingroup navigation_server move_base_server
  */
-class CostmapWrapper : public costmap_2d::Costmap2DROS
+class CostmapWrapper : private ThreadSnapshot, public costmap_2d::Costmap2DROS
 {
 public:
   typedef boost::shared_ptr<CostmapWrapper> Ptr;
 
+  //! Immutable copy of the costmap; see getSnapshot
+  typedef CostmapSnapshots::SnapshotPtr SnapshotPtr;
+
+  /**
+   * @brief Usage statistics of the costmap, to size its shutdown policy on facts.
+   */
+  struct UsageStats
+  {
+    double total_time;         //!< time since the costmap was created, in seconds
+    double active_time;        //!< time the costmap has been active, in seconds
+    unsigned int activations;  //!< number of times the costmap has been started after a shutdown
+    double update_cpu_time;    //!< CPU time used by the map update thread, in seconds; negative if not available
+  };
+
   /**
    * @brief Constructor
    * @param tf_listener_ptr Shared pointer to a common TransformListener
@@ -77,7 +139,7 @@ public:
   virtual ~CostmapWrapper();
 
   /**
-   * @brief Reconfiguration method called by dynamic reconfigure.
+   * @brief Reconfiguration method called by dynamic reconfigure. Policies set on the costmap namespace prevail.
    * @param shutdown_costmap Determines whether or not to shutdown the costmap when move_base_flex is inactive.
    * @param shutdown_costmap_delay How long in seconds to wait after last action before shutting down the costmap.
    */
@@ -89,21 +151,85 @@ public:
   void clear();
 
   /**
-   * @brief Check whether the costmap should be activated.
+   * @brief Check whether the costmap should be activated. If it's being started (e.g. pre-warmed), waits for it to
+   * be ready up to the costmap_prewarm_timeout, and continues anyway afterwards.
    */
   void checkActivate();
 
+  /**
+   * @brief Starts the costmap on the background, if shut down, so it's ready by the time an action needs it. It
+   * will be shut down again after shutdown_costmap_delay if no action uses it. Doesn't block.
+   */
+  void prewarm();
+
   /**
    * @brief Check whether the costmap should and could be deactivated.
    */
   void checkDeactivate();
 
+  /**
+   * @brief Gets an immutable snapshot of the costmap, so it can be used for a long time (e.g. for planning) without
+   * blocking the costmap updates; see CostmapSnapshots::getSnapshot.
+   * @return Shared pointer to the snapshot; keep it for as long as you use it
+   */
+  SnapshotPtr getSnapshot();
+
+  /**
+   * @brief Gets an immutable snapshot of a region of the costmap, e.g. the corridor between start and goal of a plan;
+   * see CostmapSnapshots::getRegionSnapshot.
+   * @param min_x Minimum x coordinate of the region, on the costmap global frame
+   * @param min_y Minimum y coordinate of the region, on the costmap global frame
+   * @param max_x Maximum x coordinate of the region, on the costmap global frame
+   * @param max_y Maximum y coordinate of the region, on the costmap global frame
+   * @return Shared pointer to the snapshot, or an empty pointer if the region is outside the costmap
+   */
+  SnapshotPtr getRegionSnapshot(double min_x, double min_y, double max_x, double max_y);
+
+  /**
+   * @brief Gets the usage statistics of the costmap.
+   * @param stats The usage statistics
+   */
+  void getUsageStats(UsageStats &stats);
+
 private:
+  /**
+   * @brief Gets the usage statistics of the costmap; check_costmap_mutex_ must be locked.
+   * @param stats The usage statistics
+   */
+  void getUsageStatsLocked(UsageStats &stats);
+
+  /**
+   * @brief Publishes the usage statistics as a diagnostic status, and logs them if requested.
+   * @param stats The usage statistics
+   * @param log Whether to log them
+   */
+  void publishUsage(const UsageStats &stats, bool log = false);
+
+  /**
+   * @brief Timer-triggered publication of the usage statistics.
+   */
+  void publishUsageTimer(const ros::WallTimerEvent &event);
+
   /**
    * @brief Timer-triggered deactivation of the costmap.
    */
   void deactivate(const ros::TimerEvent &event);
 
+  /**
+   * @brief Starts the costmap on the background. Requires locking check_costmap_mutex_.
+   */
+  void startAsync();
+
+  /**
+   * @brief Body of the background start thread; start blocks until the layers are up and the map initialized.
+   */
+  void startThread();
+
+  /**
+   * @brief Arms the delayed shutdown timer. Requires locking check_costmap_mutex_.
+   */
+  void scheduleDeactivate();
+
   //! Private node handle
   ros::NodeHandle private_nh_;
 
@@ -113,6 +239,27 @@ private:
   int16_t costmap_users_;                //!< keep track of plugins using costmap
   ros::Timer shutdown_costmap_timer_;    //!< costmap delayed shutdown timer
   ros::Duration shutdown_costmap_delay_; //!< costmap delayed shutdown delay
+  ros::Duration prewarm_timeout_;        //!< how long to wait for a costmap being started before using it anyway
+  bool active_;                          //!< costmap started (or being started)
+  bool starting_;                        //!< costmap being started on the background
+  boost::condition_variable started_cv_; //!< notified once the background start completes
+  boost::thread start_thread_;           //!< background start thread
+
+  bool has_shutdown_override_;           //!< shutdown_costmap set on the costmap namespace; prevails over global
+  bool shutdown_override_;               //!< shutdown policy set on the costmap namespace
+  bool has_delay_override_;              //!< shutdown_costmap_delay set on the costmap namespace; prevails too
+  ros::Duration delay_override_;         //!< shutdown delay set on the costmap namespace
+
+  std::map<pid_t, unsigned long long> update_threads_;  //!< threads spawned by Costmap2DROS, that is, its map
+                                                        //!< update thread, with their start times
+  ros::WallTime created_;                //!< time of creation of the costmap
+  ros::WallTime active_since_;           //!< time of the last activation
+  ros::WallDuration active_time_;        //!< accumulated active time, up to the last deactivation
+  unsigned int activations_;             //!< number of starts after a shutdown
+  ros::Publisher usage_pub_;             //!< publisher for the usage statistics
+  ros::WallTimer usage_timer_;           //!< timer to periodically publish the usage statistics
+
+  CostmapSnapshots snapshots_;           //!< immutable snapshots of the costmap, for planning
 };
 
 } /* namespace mbf_costmap_nav */
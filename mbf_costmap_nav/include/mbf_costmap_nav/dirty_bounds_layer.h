@@ -0,0 +1,98 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  dirty_bounds_layer.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_COSTMAP_NAV__DIRTY_BOUNDS_LAYER_H_
+#define MBF_COSTMAP_NAV__DIRTY_BOUNDS_LAYER_H_
+
+#include <costmap_2d/layer.h>
+
+
+namespace mbf_costmap_nav
+{
+
+/**
+ * @brief Pseudo-layer that doesn't modify the costmap, but keeps track of the window of the master grid updated since
+ * the last call to takeDirtyWindow. Added as the last layer of a costmap, it tells which cells have changed, so
+ * snapshots can be brought up to date copying just that window.
+ * As all layers, it's accessed with the master grid mutex locked.
+ *
+ * @ingroup move_base_server
+ */
+class DirtyBoundsLayer : public costmap_2d::Layer
+{
+public:
+  DirtyBoundsLayer();
+
+  virtual void onInitialize();
+
+  virtual void updateBounds(double robot_x, double robot_y, double robot_yaw,
+                            double* min_x, double* min_y, double* max_x, double* max_y);
+
+  virtual void updateCosts(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j);
+
+  /**
+   * @brief The master grid has been resized; everything is dirty.
+   */
+  virtual void matchSize();
+
+  /**
+   * @brief The master grid is being reset; everything is dirty.
+   */
+  virtual void reset();
+
+  /**
+   * @brief Gets the window of the master grid updated since the last call, and starts tracking again from scratch.
+   * @param min_i Minimum x index of the window (inclusive)
+   * @param min_j Minimum y index of the window (inclusive)
+   * @param max_i Maximum x index of the window (exclusive)
+   * @param max_j Maximum y index of the window (exclusive)
+   * @return false if the whole master grid is dirty (window is not set)
+   */
+  bool takeDirtyWindow(int& min_i, int& min_j, int& max_i, int& max_j);
+
+private:
+  bool all_dirty_;     //!< the whole master grid is dirty
+  int min_i_, min_j_;  //!< minimum indices of the dirty window (inclusive)
+  int max_i_, max_j_;  //!< maximum indices of the dirty window (exclusive); empty window if max <= min
+};
+
+} /* namespace mbf_costmap_nav */
+
+#endif /* MBF_COSTMAP_NAV__DIRTY_BOUNDS_LAYER_H_ */
@@ -37,22 +37,49 @@
  *    Jorge Santos Simón <santos@magazino.eu>
  *
  */
+#include <boost/make_shared.hpp>
+
 #include "mbf_costmap_nav/costmap_controller_execution.h"
 
 namespace mbf_costmap_nav
 {
 
+void CostmapControllerExecution::Settings::loadParams(const ros::NodeHandle& private_nh)
+{
+  mbf_abstract_nav::AbstractControllerExecution::Settings::loadParams(private_nh);
+  private_nh.param("controller_lock_costmap", lock_costmap, true);
+}
+
+CostmapControllerExecution::Settings::ConstPtr CostmapControllerExecution::Settings::load(
+    const ros::NodeHandle& private_nh)
+{
+  boost::shared_ptr<Settings> settings = boost::make_shared<Settings>();
+  settings->loadParams(private_nh);
+  return settings;
+}
+
+CostmapControllerExecution::CostmapControllerExecution(const std::string& controller_name,
+                                                       const mbf_costmap_core::CostmapController::Ptr& controller_ptr,
+                                                       const mbf_utility::RobotInformation& robot_info,
+                                                       const ros::Publisher& vel_pub,
+                                                       const CostmapWrapper::Ptr& costmap_ptr,
+                                                       const MoveBaseFlexConfig& config)
+  : CostmapControllerExecution(controller_name, controller_ptr, robot_info, vel_pub, costmap_ptr,
+                               Settings::load(ros::NodeHandle("~")), config)
+{
+}
+
 CostmapControllerExecution::CostmapControllerExecution(const std::string& controller_name,
                                                        const mbf_costmap_core::CostmapController::Ptr& controller_ptr,
                                                        const mbf_utility::RobotInformation& robot_info,
                                                        const ros::Publisher& vel_pub,
                                                        const CostmapWrapper::Ptr& costmap_ptr,
+                                                       const Settings::ConstPtr& settings,
                                                        const MoveBaseFlexConfig& config)
-  : AbstractControllerExecution(controller_name, controller_ptr, robot_info, vel_pub, toAbstract(config))
+  : AbstractControllerExecution(controller_name, controller_ptr, robot_info, vel_pub, settings, toAbstract(config))
   , costmap_ptr_(costmap_ptr)
+  , lock_costmap_(settings->lock_costmap)
 {
-  ros::NodeHandle private_nh("~");
-  private_nh.param("controller_lock_costmap", lock_costmap_, true);
 }
 
 CostmapControllerExecution::~CostmapControllerExecution()
@@ -66,9 +93,12 @@ mbf_abstract_nav::MoveBaseFlexConfig CostmapControllerExecution::toAbstract(cons
   abstract_config.controller_frequency = config.controller_frequency;
   abstract_config.controller_patience = config.controller_patience;
   abstract_config.controller_max_retries = config.controller_max_retries;
+  abstract_config.controller_min_frequency = config.controller_min_frequency;
+  abstract_config.controller_max_utilization = config.controller_max_utilization;
   abstract_config.oscillation_timeout = config.oscillation_timeout;
   abstract_config.oscillation_distance = config.oscillation_distance;
   abstract_config.oscillation_angle = config.oscillation_angle;
+  abstract_config.oscillation_min_path_efficiency = config.oscillation_min_path_efficiency;
   return abstract_config;
 }
 
@@ -74,12 +74,9 @@ static std::string getStringElement(const XmlRpc::XmlRpcValue& value, const std:
  *
  * @param resource The name of the resource (e.g 'planners').
  * @param nh The private node handle containing the given resource.
- * @param global_costmap_ptr Ptr to the global costmap.
- * @param local_costmap_ptr Ptr to the local costmap.
+ * @param costmaps All the costmaps by name; 'global' and 'local' are also accepted for the global and local costmaps.
  */
-StringToMap loadStringToMapsImpl(const std::string& resource, const ros::NodeHandle& nh,
-                                 const CostmapWrapper::Ptr& global_costmap_ptr,
-                                 const CostmapWrapper::Ptr& local_costmap_ptr)
+StringToMap loadStringToMapsImpl(const std::string& resource, const ros::NodeHandle& nh, const StringToMap& costmaps)
 {
   using namespace XmlRpc;
   XmlRpcValue raw;
@@ -92,11 +89,11 @@ StringToMap loadStringToMapsImpl(const std::string& resource, const ros::NodeHan
   if (raw.getType() != XmlRpcValue::TypeArray)
     throw std::runtime_error(resource + " must be an XmlRpcValue::TypeArray");
 
-  StringToMap output, mapping;
+  StringToMap output, mapping(costmaps);
 
-  // We support only 'local' or 'global' names for the costmap tag.
-  mapping["global"] = global_costmap_ptr;
-  mapping["local"] = local_costmap_ptr;
+  // We support the costmap names, plus the 'local' and 'global' short names used before having named costmaps.
+  mapping["global"] = costmaps.at("global_costmap");
+  mapping["local"] = costmaps.at("local_costmap");
 
   const int size = raw.size();
   for (int ii = 0; ii != size; ++ii)
@@ -118,7 +115,7 @@ StringToMap loadStringToMapsImpl(const std::string& resource, const ros::NodeHan
       const std::string name = getStringElement(element, "name");
       const std::string costmap = getStringElement(element, "costmap");
 
-      // If the costmap tag is not 'local' or 'global', we will throw.
+      // If the costmap tag is not a costmap name, 'local' or 'global', we will throw.
       output[name] = mapping.at(costmap);
     }
     catch (const XmlRpcException& ex)
@@ -127,7 +124,7 @@ StringToMap loadStringToMapsImpl(const std::string& resource, const ros::NodeHan
     }
     catch (const std::out_of_range& _ex)
     {
-      ROS_ERROR_STREAM("Unknown costmap name. It must be either 'local' or 'global'");
+      ROS_ERROR_STREAM("Unknown costmap name. It must be either 'local', 'global' or one of the costmaps parameter");
     }
   }
   return output;
@@ -137,13 +134,11 @@ StringToMap loadStringToMapsImpl(const std::string& resource, const ros::NodeHan
  * @brief Non-throwing version of loadStringToMapsImpl.
  * @copydetails loadStringToMapsImpl
  */
-StringToMap loadStringToMaps(const std::string& resource, const ros::NodeHandle& nh,
-                             const CostmapWrapper::Ptr& global_costmap_ptr,
-                             const CostmapWrapper::Ptr& local_costmap_ptr)
+StringToMap loadStringToMaps(const std::string& resource, const ros::NodeHandle& nh, const StringToMap& costmaps)
 {
   try
   {
-    return loadStringToMapsImpl(resource, nh, global_costmap_ptr, local_costmap_ptr);
+    return loadStringToMapsImpl(resource, nh, costmaps);
   }
   catch (const XmlRpc::XmlRpcException& _ex)
   {
@@ -156,6 +151,19 @@ StringToMap loadStringToMaps(const std::string& resource, const ros::NodeHandle&
   return StringToMap();
 }
 
+/**
+ * @brief Returns the names of the additional costmaps, from the costmaps parameter. Non-throwing.
+ *
+ * @param nh The private node handle containing the costmaps parameter.
+ */
+std::vector<std::string> loadCostmapNames(const ros::NodeHandle& nh)
+{
+  std::vector<std::string> names;
+  if (nh.hasParam("costmaps") && !nh.getParam("costmaps", names))
+    ROS_ERROR_STREAM("Failed to load the additional costmaps: costmaps must be a list of names");
+  return names;
+}
+
 CostmapNavigationServer::CostmapNavigationServer(const TFPtr& tf_listener_ptr)
   : AbstractNavigationServer(tf_listener_ptr)
   , recovery_plugin_loader_("mbf_costmap_core", "mbf_costmap_core::CostmapRecovery")
@@ -167,7 +175,25 @@ CostmapNavigationServer::CostmapNavigationServer(const TFPtr& tf_listener_ptr)
   , global_costmap_ptr_(new CostmapWrapper("global_costmap", tf_listener_ptr_))
   , local_costmap_ptr_(new CostmapWrapper("local_costmap", tf_listener_ptr_))
   , setup_reconfigure_(false)
+  , costmap_planner_settings_(CostmapPlannerExecution::Settings::load(private_nh_))
+  , costmap_controller_settings_(CostmapControllerExecution::Settings::load(private_nh_))
 {
+  costmaps_["global_costmap"] = global_costmap_ptr_;
+  costmaps_["local_costmap"] = local_costmap_ptr_;
+
+  // additional costmaps, e.g. small and high resolution ones for specialized planners; each one is configured on
+  // its own namespace, as the local and global costmaps, so it can have its own size, resolution and update rate
+  for (const std::string& name : loadCostmapNames(private_nh_))
+  {
+    if (costmaps_.count(name))
+    {
+      ROS_ERROR_STREAM("Costmap \"" << name << "\" already exists; ignoring it");
+      continue;
+    }
+    costmaps_[name] = boost::make_shared<CostmapWrapper>(name, tf_listener_ptr_);
+    ROS_INFO_STREAM("Additional costmap \"" << name << "\" created");
+  }
+
   // advertise services and current goal topic
   check_point_cost_srv_ =
       private_nh_.advertiseService("check_point_cost", &CostmapNavigationServer::callServiceCheckPointCost, this);
@@ -181,15 +207,16 @@ CostmapNavigationServer::CostmapNavigationServer(const TFPtr& tf_listener_ptr)
       private_nh_.advertiseService("update_costmaps", &CostmapNavigationServer::callServiceUpdateCostmaps, this);
   clear_costmaps_srv_ =
       private_nh_.advertiseService("clear_costmaps", &CostmapNavigationServer::callServiceClearCostmaps, this);
+  prewarm_costmaps_srv_ =
+      private_nh_.advertiseService("prewarm_costmaps", &CostmapNavigationServer::callServicePrewarmCostmaps, this);
 
   // dynamic reconfigure server for mbf_costmap_nav configuration; also include abstract server parameters
   dsrv_costmap_ = boost::make_shared<dynamic_reconfigure::Server<mbf_costmap_nav::MoveBaseFlexConfig> >(private_nh_);
   dsrv_costmap_->setCallback(boost::bind(&CostmapNavigationServer::reconfigure, this, _1, _2));
 
   // Load the optional mapping from planner/controller name to the costmap.
-  planner_name_to_costmap_ptr_ = loadStringToMaps("planners", private_nh_, global_costmap_ptr_, local_costmap_ptr_);
-  controller_name_to_costmap_ptr_ =
-      loadStringToMaps("controllers", private_nh_, global_costmap_ptr_, local_costmap_ptr_);
+  planner_name_to_costmap_ptr_ = loadStringToMaps("planners", private_nh_, costmaps_);
+  controller_name_to_costmap_ptr_ = loadStringToMaps("controllers", private_nh_, costmaps_);
 
   // initialize all plugins
   initializeServerComponents();
@@ -228,7 +255,7 @@ mbf_abstract_nav::AbstractPlannerExecution::Ptr CostmapNavigationServer::newPlan
       findWithDefault(planner_name_to_costmap_ptr_, plugin_name, global_costmap_ptr_);
   return boost::make_shared<mbf_costmap_nav::CostmapPlannerExecution>(
       plugin_name, boost::static_pointer_cast<mbf_costmap_core::CostmapPlanner>(plugin_ptr), robot_info_, costmap_ptr,
-      last_config_);
+      costmap_planner_settings_, last_config_);
 }
 
 mbf_abstract_nav::AbstractControllerExecution::Ptr CostmapNavigationServer::newControllerExecution(
@@ -238,7 +265,7 @@ mbf_abstract_nav::AbstractControllerExecution::Ptr CostmapNavigationServer::newC
       findWithDefault(controller_name_to_costmap_ptr_, plugin_name, local_costmap_ptr_);
   return boost::make_shared<mbf_costmap_nav::CostmapControllerExecution>(
       plugin_name, boost::static_pointer_cast<mbf_costmap_core::CostmapController>(plugin_ptr), robot_info_, vel_pub_,
-      costmap_ptr, last_config_);
+      costmap_ptr, costmap_controller_settings_, last_config_);
 }
 
 mbf_abstract_nav::AbstractRecoveryExecution::Ptr CostmapNavigationServer::newRecoveryExecution(
@@ -432,9 +459,9 @@ bool CostmapNavigationServer::initializeRecoveryPlugin(const std::string& name,
 void CostmapNavigationServer::stop()
 {
   AbstractNavigationServer::stop();
-  ROS_INFO_STREAM_NAMED("mbf_costmap_nav", "Stopping local and global costmap for shutdown");
-  local_costmap_ptr_->stop();
-  global_costmap_ptr_->stop();
+  ROS_INFO_STREAM_NAMED("mbf_costmap_nav", "Stopping all costmaps for shutdown");
+  for (const auto& [name, costmap] : costmaps_)
+    costmap->stop();
 }
 
 void CostmapNavigationServer::reconfigure(mbf_costmap_nav::MoveBaseFlexConfig& config, uint32_t level)
@@ -458,20 +485,27 @@ void CostmapNavigationServer::reconfigure(mbf_costmap_nav::MoveBaseFlexConfig& c
   abstract_config.planner_frequency = config.planner_frequency;
   abstract_config.planner_patience = config.planner_patience;
   abstract_config.planner_max_retries = config.planner_max_retries;
+  abstract_config.replanning_prediction_horizon = config.replanning_prediction_horizon;
+  abstract_config.replanning_min_improvement = config.replanning_min_improvement;
+  abstract_config.replanning_max_divergence = config.replanning_max_divergence;
   abstract_config.controller_frequency = config.controller_frequency;
   abstract_config.controller_patience = config.controller_patience;
   abstract_config.controller_max_retries = config.controller_max_retries;
+  abstract_config.controller_min_frequency = config.controller_min_frequency;
+  abstract_config.controller_max_utilization = config.controller_max_utilization;
+  abstract_config.controller_feedback_frequency = config.controller_feedback_frequency;
   abstract_config.recovery_enabled = config.recovery_enabled;
   abstract_config.recovery_patience = config.recovery_patience;
   abstract_config.oscillation_timeout = config.oscillation_timeout;
   abstract_config.oscillation_distance = config.oscillation_distance;
   abstract_config.oscillation_angle = config.oscillation_angle;
+  abstract_config.oscillation_min_path_efficiency = config.oscillation_min_path_efficiency;
   abstract_config.restore_defaults = config.restore_defaults;
   mbf_abstract_nav::AbstractNavigationServer::reconfigure(abstract_config, level);
 
   // also reconfigure costmaps
-  local_costmap_ptr_->reconfigure(config.shutdown_costmaps, config.shutdown_costmaps_delay);
-  global_costmap_ptr_->reconfigure(config.shutdown_costmaps, config.shutdown_costmaps_delay);
+  for (const auto& [name, costmap] : costmaps_)
+    costmap->reconfigure(config.shutdown_costmaps, config.shutdown_costmaps_delay);
 
   last_config_ = config;
 }
@@ -479,24 +513,10 @@ void CostmapNavigationServer::reconfigure(mbf_costmap_nav::MoveBaseFlexConfig& c
 bool CostmapNavigationServer::callServiceCheckPointCost(mbf_msgs::CheckPoint::Request& request,
                                                         mbf_msgs::CheckPoint::Response& response)
 {
-  // selecting the requested costmap
-  CostmapWrapper::Ptr costmap;
-  std::string costmap_name;
-  switch (request.costmap)
+  const auto& [costmap_name, costmap] = requestedCostmap(request.costmap, request.costmap_name);
+  if (!costmap)
   {
-    case mbf_msgs::CheckPoint::Request::LOCAL_COSTMAP:
-      costmap = local_costmap_ptr_;
-      costmap_name = "local costmap";
-      break;
-    case mbf_msgs::CheckPoint::Request::GLOBAL_COSTMAP:
-      costmap = global_costmap_ptr_;
-      costmap_name = "global costmap";
-      break;
-    default:
-      ROS_ERROR_STREAM("No valid costmap provided; options are "
-                       << mbf_msgs::CheckPoint::Request::LOCAL_COSTMAP << ": local costmap, "
-                       << mbf_msgs::CheckPoint::Request::GLOBAL_COSTMAP << ": global costmap");
-      return false;
+    return false;
   }
 
   // get target point as x, y coordinates
@@ -556,24 +576,10 @@ bool CostmapNavigationServer::callServiceCheckPointCost(mbf_msgs::CheckPoint::Re
 bool CostmapNavigationServer::callServiceCheckPoseCost(mbf_msgs::CheckPose::Request& request,
                                                        mbf_msgs::CheckPose::Response& response)
 {
-  // selecting the requested costmap
-  CostmapWrapper::Ptr costmap;
-  std::string costmap_name;
-  switch (request.costmap)
+  const auto& [costmap_name, costmap] = requestedCostmap(request.costmap, request.costmap_name);
+  if (!costmap)
   {
-    case mbf_msgs::CheckPose::Request::LOCAL_COSTMAP:
-      costmap = local_costmap_ptr_;
-      costmap_name = "local costmap";
-      break;
-    case mbf_msgs::CheckPose::Request::GLOBAL_COSTMAP:
-      costmap = global_costmap_ptr_;
-      costmap_name = "global costmap";
-      break;
-    default:
-      ROS_ERROR_STREAM("No valid costmap provided; options are "
-                       << mbf_msgs::CheckPose::Request::LOCAL_COSTMAP << ": local costmap, "
-                       << mbf_msgs::CheckPose::Request::GLOBAL_COSTMAP << ": global costmap");
-      return false;
+    return false;
   }
 
   // get target pose or current robot pose as x, y, yaw coordinates
@@ -680,7 +686,7 @@ bool CostmapNavigationServer::callServiceCheckPoseCost(mbf_msgs::CheckPose::Requ
 bool CostmapNavigationServer::callServiceCheckPathCost(mbf_msgs::CheckPath::Request& request,
                                                        mbf_msgs::CheckPath::Response& response)
 {
-  const auto& [costmap_name, costmap] = requestedCostmap(request.costmap);
+  const auto& [costmap_name, costmap] = requestedCostmap(request.costmap, request.costmap_name);
   if (!costmap)
   {
     return false;
@@ -814,17 +820,17 @@ bool CostmapNavigationServer::callServiceCheckPathCost(mbf_msgs::CheckPath::Requ
 bool CostmapNavigationServer::callServiceClearCostmaps(std_srvs::Empty::Request& request,
                                                        std_srvs::Empty::Response& response)
 {
-  // clear both costmaps
-  local_costmap_ptr_->clear();
-  global_costmap_ptr_->clear();
+  // clear all costmaps
+  for (const auto& [name, costmap] : costmaps_)
+    costmap->clear();
   return true;
 }
 
 bool CostmapNavigationServer::callServiceUpdateCostmaps(std_srvs::Empty::Request& request,
                                                         std_srvs::Empty::Response& response)
 {
-  // update both costmaps
-  for (auto costmap : { local_costmap_ptr_, global_costmap_ptr_ })
+  // update all costmaps
+  for (const auto& [name, costmap] : costmaps_)
   {
     costmap->checkActivate();
     costmap->updateMap();
@@ -834,10 +840,37 @@ bool CostmapNavigationServer::callServiceUpdateCostmaps(std_srvs::Empty::Request
   return true;
 }
 
-std::pair<std::string, CostmapWrapper::Ptr> CostmapNavigationServer::requestedCostmap(std::uint8_t costmap_type) const
+bool CostmapNavigationServer::callServicePrewarmCostmaps(std_srvs::Empty::Request& request,
+                                                         std_srvs::Empty::Response& response)
+{
+  // start all costmaps on the background; actions using them will wait until they are ready
+  for (const auto& [name, costmap] : costmaps_)
+    costmap->prewarm();
+  return true;
+}
+
+void CostmapNavigationServer::callActionMoveBase(mbf_abstract_nav::ActionServerMoveBase::GoalHandle goal_handle)
+{
+  local_costmap_ptr_->prewarm();
+  global_costmap_ptr_->prewarm();
+  AbstractNavigationServer::callActionMoveBase(goal_handle);
+}
+
+std::pair<std::string, CostmapWrapper::Ptr>
+CostmapNavigationServer::requestedCostmap(std::uint8_t costmap_type, const std::string& costmap_name) const
 {
   // selecting the requested costmap
   CostmapWrapper::Ptr costmap;
+  if (!costmap_name.empty())
+  {
+    const StringToMap::const_iterator named_costmap = costmaps_.find(costmap_name);
+    if (named_costmap != costmaps_.end())
+      return *named_costmap;
+
+    ROS_ERROR_STREAM("No costmap named \"" << costmap_name << "\"");
+    return { "", costmap };
+  }
+
   switch (costmap_type)
   {
     case mbf_msgs::CheckPose::Request::LOCAL_COSTMAP:
@@ -857,7 +890,7 @@ std::pair<std::string, CostmapWrapper::Ptr> CostmapNavigationServer::requestedCo
 bool CostmapNavigationServer::callServiceFindValidPose(mbf_msgs::FindValidPose::Request& request,
                                                        mbf_msgs::FindValidPose::Response& response)
 {
-  const auto& [costmap_name, costmap] = requestedCostmap(request.costmap);
+  const auto& [costmap_name, costmap] = requestedCostmap(request.costmap, request.costmap_name);
   if (!costmap)
   {
     return false;
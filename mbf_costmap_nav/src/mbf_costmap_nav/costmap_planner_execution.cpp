@@ -37,6 +37,9 @@
  *    Jorge Santos Simón <santos@magazino.eu>
  *
  */
+#include <algorithm>
+
+#include <boost/make_shared.hpp>
 #include <nav_core_wrapper/wrapper_global_planner.h>
 #include <mbf_msgs/GetPathResult.h>
 
@@ -44,15 +47,44 @@
 
 namespace mbf_costmap_nav
 {
+void CostmapPlannerExecution::Settings::loadParams(const ros::NodeHandle& private_nh)
+{
+  mbf_abstract_nav::AbstractPlannerExecution::Settings::loadParams(private_nh);
+  private_nh.param("planner_lock_costmap", lock_costmap, true);
+  private_nh.param("planner_use_snapshots", use_snapshots, true);
+  private_nh.param("planner_snapshot_region_margin", snapshot_region_margin, 0.0);
+}
+
+CostmapPlannerExecution::Settings::ConstPtr CostmapPlannerExecution::Settings::load(const ros::NodeHandle& private_nh)
+{
+  boost::shared_ptr<Settings> settings = boost::make_shared<Settings>();
+  settings->loadParams(private_nh);
+  return settings;
+}
+
+CostmapPlannerExecution::CostmapPlannerExecution(const std::string& planner_name,
+                                                 const mbf_costmap_core::CostmapPlanner::Ptr& planner_ptr,
+                                                 const mbf_utility::RobotInformation& robot_info,
+                                                 const CostmapWrapper::Ptr& costmap_ptr,
+                                                 const MoveBaseFlexConfig& config)
+  : CostmapPlannerExecution(planner_name, planner_ptr, robot_info, costmap_ptr,
+                            Settings::load(ros::NodeHandle("~")), config)
+{
+}
+
 CostmapPlannerExecution::CostmapPlannerExecution(const std::string& planner_name,
                                                  const mbf_costmap_core::CostmapPlanner::Ptr& planner_ptr,
                                                  const mbf_utility::RobotInformation& robot_info,
                                                  const CostmapWrapper::Ptr& costmap_ptr,
+                                                 const Settings::ConstPtr& settings,
                                                  const MoveBaseFlexConfig& config)
-  : AbstractPlannerExecution(planner_name, planner_ptr, robot_info, toAbstract(config)), costmap_ptr_(costmap_ptr)
+  : AbstractPlannerExecution(planner_name, planner_ptr, robot_info, settings, toAbstract(config))
+  , costmap_ptr_(costmap_ptr)
+  , costmap_planner_(planner_ptr)
+  , lock_costmap_(settings->lock_costmap)
+  , use_snapshots_(settings->use_snapshots)
+  , snapshot_region_margin_(settings->snapshot_region_margin)
 {
-  ros::NodeHandle private_nh("~");
-  private_nh.param("planner_lock_costmap", lock_costmap_, true);
 }
 
 CostmapPlannerExecution::~CostmapPlannerExecution()
@@ -90,6 +122,26 @@ uint32_t CostmapPlannerExecution::makePlan(const geometry_msgs::PoseStamped &sta
   if (!mbf_utility::transformPose(robot_info_.getTransformListener(), frame, timeout, goal, g_goal))
     return mbf_msgs::GetPathResult::TF_ERROR;
 
+  if (use_snapshots_ && costmap_planner_->supportsSnapshots())
+  {
+    // plan on an immutable snapshot, so we don't block the costmap updates while planning; no need to lock it
+    CostmapWrapper::SnapshotPtr snapshot;
+    if (snapshot_region_margin_ > 0.0)
+    {
+      // copy just the region around start and goal, so the costmap is locked for a time proportional to its area;
+      // the planner cannot go beyond it, so the margin must leave room enough to get around obstacles
+      const double margin = snapshot_region_margin_ + tolerance;
+      snapshot = costmap_ptr_->getRegionSnapshot(
+          std::min(g_start.pose.position.x, g_goal.pose.position.x) - margin,
+          std::min(g_start.pose.position.y, g_goal.pose.position.y) - margin,
+          std::max(g_start.pose.position.x, g_goal.pose.position.x) + margin,
+          std::max(g_start.pose.position.y, g_goal.pose.position.y) + margin);
+    }
+    if (!snapshot)
+      snapshot = costmap_ptr_->getSnapshot();
+    return costmap_planner_->makePlanOnSnapshot(g_start, g_goal, tolerance, *snapshot, plan, cost, message);
+  }
+
   if (lock_costmap_)
   {
     boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*(costmap_ptr_->getCostmap()->getMutex()));
@@ -0,0 +1,138 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  costmap_snapshots.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <algorithm>
+
+#include <boost/make_shared.hpp>
+
+#include "mbf_costmap_nav/costmap_snapshots.h"
+
+
+namespace mbf_costmap_nav
+{
+
+CostmapSnapshots::CostmapSnapshots(costmap_2d::LayeredCostmap &layered_costmap, const std::string &name,
+                                   tf2_ros::Buffer *tf)
+  : costmap_(*layered_costmap.getCostmap()), dirty_bounds_layer_(boost::make_shared<DirtyBoundsLayer>())
+{
+  boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*costmap_.getMutex());
+  layered_costmap.addPlugin(dirty_bounds_layer_);
+  dirty_bounds_layer_->initialize(&layered_costmap, name, tf);
+}
+
+CostmapSnapshots::SnapshotPtr CostmapSnapshots::getSnapshot()
+{
+  boost::mutex::scoped_lock snapshot_lock(snapshot_mutex_);
+
+  if (snapshot_ && !snapshot_.unique())
+  {
+    // the last snapshot is still in use, so we cannot update it; copy it without holding the costmap lock, and then
+    // update the copy with the changes since it was taken
+    snapshot_ = boost::make_shared<costmap_2d::Costmap2D>(*snapshot_);
+  }
+
+  boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*costmap_.getMutex());
+
+  int min_i, min_j, max_i, max_j;
+  const bool window = dirty_bounds_layer_->takeDirtyWindow(min_i, min_j, max_i, max_j);
+  if (!snapshot_ || !window ||
+      snapshot_->getSizeInCellsX() != costmap_.getSizeInCellsX() ||
+      snapshot_->getSizeInCellsY() != costmap_.getSizeInCellsY() ||
+      snapshot_->getResolution() != costmap_.getResolution() ||
+      snapshot_->getOriginX() != costmap_.getOriginX() || snapshot_->getOriginY() != costmap_.getOriginY())
+  {
+    // first snapshot, or the map has been reset, resized or moved (rolling window); copy it completely
+    if (snapshot_)
+      *snapshot_ = costmap_;
+    else
+      snapshot_ = boost::make_shared<costmap_2d::Costmap2D>(costmap_);
+    return snapshot_;
+  }
+
+  // copy just the window updated since the last snapshot; empty if the map has not been updated
+  const unsigned int size_x = costmap_.getSizeInCellsX();
+  min_i = std::max(min_i, 0);
+  min_j = std::max(min_j, 0);
+  max_i = std::min(max_i, static_cast<int>(size_x));
+  max_j = std::min(max_j, static_cast<int>(costmap_.getSizeInCellsY()));
+  for (int j = min_j; j < max_j && min_i < max_i; ++j)
+  {
+    std::copy(costmap_.getCharMap() + j * size_x + min_i, costmap_.getCharMap() + j * size_x + max_i,
+              snapshot_->getCharMap() + j * size_x + min_i);
+  }
+  return snapshot_;
+}
+
+CostmapSnapshots::SnapshotPtr CostmapSnapshots::getRegionSnapshot(double min_x, double min_y,
+                                                                 double max_x, double max_y)
+{
+  boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*costmap_.getMutex());
+
+  // note that getSizeInMeters falls half a cell short of the costmap bounds
+  const double resolution = costmap_.getResolution();
+  if (min_x > max_x || min_y > max_y ||
+      max_x < costmap_.getOriginX() || min_x >= costmap_.getOriginX() + costmap_.getSizeInCellsX() * resolution ||
+      max_y < costmap_.getOriginY() || min_y >= costmap_.getOriginY() + costmap_.getSizeInCellsY() * resolution)
+  {
+    return SnapshotPtr();
+  }
+
+  // snap the region to the cells containing its corners, cropped to the costmap bounds; we don't use
+  // copyCostmapWindow, as it fails for regions reaching the upper bounds and doesn't align the window to the cells
+  int min_i, min_j, max_i, max_j;
+  costmap_.worldToMapEnforceBounds(min_x, min_y, min_i, min_j);
+  costmap_.worldToMapEnforceBounds(max_x, max_y, max_i, max_j);
+
+  const unsigned int size_x = costmap_.getSizeInCellsX();
+  const unsigned int window_size_x = max_i - min_i + 1;
+  const unsigned int window_size_y = max_j - min_j + 1;
+  const boost::shared_ptr<costmap_2d::Costmap2D> snapshot = boost::make_shared<costmap_2d::Costmap2D>(
+      window_size_x, window_size_y, resolution,
+      costmap_.getOriginX() + min_i * resolution, costmap_.getOriginY() + min_j * resolution,
+      costmap_.getDefaultValue());
+  for (unsigned int j = 0; j < window_size_y; ++j)
+  {
+    const unsigned char *row = costmap_.getCharMap() + (min_j + j) * size_x + min_i;
+    std::copy(row, row + window_size_x, snapshot->getCharMap() + j * window_size_x);
+  }
+  return snapshot;
+}
+
+} /* namespace mbf_costmap_nav */
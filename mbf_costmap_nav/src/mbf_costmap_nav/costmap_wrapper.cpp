@@ -38,39 +38,169 @@
  *
  */
 
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include <diagnostic_msgs/DiagnosticStatus.h>
+
 #include "mbf_costmap_nav/costmap_wrapper.h"
 
 
 namespace mbf_costmap_nav
 {
 
+ThreadSnapshot::ThreadSnapshot() : threads_before_(listThreads())
+{
+}
+
+std::set<pid_t> ThreadSnapshot::listThreads()
+{
+  std::set<pid_t> threads;
+#ifdef __linux__
+  DIR *task_dir = opendir("/proc/self/task");
+  if (!task_dir)
+    return threads;
+
+  struct dirent *entry;
+  while ((entry = readdir(task_dir)) != NULL)
+  {
+    const pid_t tid = static_cast<pid_t>(std::atoi(entry->d_name));
+    if (tid > 0)
+      threads.insert(tid);
+  }
+  closedir(task_dir);
+#endif
+  return threads;
+}
+
+bool ThreadSnapshot::readThreadInfo(pid_t tid, ThreadInfo &info)
+{
+#ifdef __linux__
+  std::stringstream path;
+  path << "/proc/self/task/" << tid << "/stat";
+  std::ifstream stat_file(path.str().c_str());
+  std::string stat;
+  if (!std::getline(stat_file, stat))
+    return false;  // thread gone
+
+  // thread name, between parentheses, can contain spaces and parentheses; utime and stime are the 12th and 13th
+  // fields after it, and starttime the 20th
+  const std::string::size_type name_begin = stat.find('(');
+  const std::string::size_type name_end = stat.rfind(')');
+  if (name_begin == std::string::npos || name_end == std::string::npos || name_end < name_begin)
+    return false;
+  info.name = stat.substr(name_begin + 1, name_end - name_begin - 1);
+
+  std::istringstream fields(stat.substr(name_end + 1));
+  std::string skip;
+  for (int i = 0; i < 11; ++i)
+    fields >> skip;
+  unsigned long utime, stime;
+  if (!(fields >> utime >> stime))
+    return false;
+  for (int i = 0; i < 6; ++i)
+    fields >> skip;
+  if (!(fields >> info.start_time))
+    return false;
+
+  info.cpu_time = static_cast<double>(utime + stime) / sysconf(_SC_CLK_TCK);
+  return true;
+#else
+  return false;
+#endif
+}
+
 
 CostmapWrapper::CostmapWrapper(const std::string &name, const TFPtr &tf_listener_ptr) :
   costmap_2d::Costmap2DROS(name, *tf_listener_ptr),
-  shutdown_costmap_(false), costmap_users_(0), private_nh_("~")
+  shutdown_costmap_(false), costmap_users_(0), private_nh_("~"), active_(true), starting_(false),
+  has_shutdown_override_(false), shutdown_override_(false), has_delay_override_(false), activations_(0),
+  // snapshots track the cells updated on each cycle with a layer that must be the last one; all the costmap layers
+  // are loaded by now, as the base class is already constructed
+  snapshots_(*layered_costmap_, name + "/dirty_bounds", tf_listener_ptr.get())
 {
+  // threads spawned while constructing Costmap2DROS are its own, namely the map update thread; we assume no other
+  // thread gets created meanwhile, as costmaps are constructed before the server starts spinning. The update thread
+  // is unnamed, so it has the process name; named threads, or threads already gone, are not ours
+  const std::set<pid_t> threads_after = listThreads();
+  std::set<pid_t> new_threads;
+  std::set_difference(threads_after.begin(), threads_after.end(), threads_before_.begin(), threads_before_.end(),
+                      std::inserter(new_threads, new_threads.begin()));
+  ThreadInfo process_info;
+  if (readThreadInfo(getpid(), process_info))
+  {
+    for (std::set<pid_t>::const_iterator tid = new_threads.begin(); tid != new_threads.end(); ++tid)
+    {
+      ThreadInfo info;
+      if (readThreadInfo(*tid, info) && info.name == process_info.name)
+        update_threads_[*tid] = info.start_time;
+    }
+  }
+  if (update_threads_.empty())
+    ROS_DEBUG_STREAM("Cannot identify " << name_ << " update thread; its CPU usage will not be available");
+
+  created_ = ros::WallTime::now();
+  active_since_ = created_;
+
+  // costmap specific shutdown policy, e.g. to keep the local costmap always hot while shutting down the global one;
+  // if set, it prevails over the server-wide shutdown_costmaps and shutdown_costmaps_delay dynamic parameters
+  ros::NodeHandle costmap_nh("~/" + name);
+  has_shutdown_override_ = costmap_nh.getParam("shutdown_costmap", shutdown_override_);
+  double delay_override;
+  has_delay_override_ = costmap_nh.getParam("shutdown_costmap_delay", delay_override);
+  if (has_delay_override_)
+    delay_override_ = ros::Duration(delay_override);
+
   // even if shutdown_costmaps is a dynamically reconfigurable parameter, we
   // need it here to decide whether to start or not the costmap on starting up
   private_nh_.param("shutdown_costmaps", shutdown_costmap_, false);
+  if (has_shutdown_override_)
+    shutdown_costmap_ = shutdown_override_;
   private_nh_.param("clear_on_shutdown", clear_on_shutdown_, false);
+  double prewarm_timeout;
+  private_nh_.param("costmap_prewarm_timeout", prewarm_timeout, 2.0);
+  prewarm_timeout_ = ros::Duration(prewarm_timeout);
 
   if (shutdown_costmap_)
+  {
     // initialize costmap stopped if shutdown_costmaps parameter is true
     stop();
+    active_ = false;
+  }
   else
     // otherwise costmap_users_ is at least 1, as costmap is always active
     ++costmap_users_;
+
+  usage_pub_ = costmap_nh.advertise<diagnostic_msgs::DiagnosticStatus>("usage", 1, true);
+  double usage_period;
+  private_nh_.param("costmap_usage_period", usage_period, 10.0);
+  if (usage_period > 0.0)
+    usage_timer_ =
+      private_nh_.createWallTimer(ros::WallDuration(usage_period), &CostmapWrapper::publishUsageTimer, this);
 }
 
 CostmapWrapper::~CostmapWrapper()
 {
+  usage_timer_.stop();
   shutdown_costmap_timer_.stop();
+  if (start_thread_.joinable())
+    start_thread_.join();
 }
 
 
 void CostmapWrapper::reconfigure(double shutdown_costmap, double shutdown_costmap_delay)
 {
-  shutdown_costmap_delay_ = ros::Duration(shutdown_costmap_delay);
+  if (has_shutdown_override_)
+    shutdown_costmap = shutdown_override_;
+  shutdown_costmap_delay_ = has_delay_override_ ? delay_override_ : ros::Duration(shutdown_costmap_delay);
   if (shutdown_costmap_delay_.isZero())
     ROS_WARN("Zero shutdown costmaps delay is not recommended, as it forces us to enable costmaps on each action");
 
@@ -99,14 +229,29 @@ void CostmapWrapper::checkActivate()
 
   shutdown_costmap_timer_.stop();
 
-  // Activate costmap if we shutdown them when not moving and they are not already active. This method must be
-  // synchronized because start costmap can take up to 1/update freq., and concurrent calls to it can lead to segfaults
-  if (shutdown_costmap_ && !costmap_users_)
+  // Activate costmap if we shutdown them when not moving and they are not already active. Starting the costmap can
+  // take up to 1/update freq., and concurrent calls to start can lead to segfaults, so we only do it on a single
+  // background thread, and wait for it here, unless it was pre-warmed and it's ready already
+  if (shutdown_costmap_ && !active_)
   {
-    start();
-    ROS_DEBUG_STREAM("" << name_ << " activated");
+    startAsync();
   }
   ++costmap_users_;
+
+  if (starting_)
+  {
+    const boost::chrono::steady_clock::time_point start_wait = boost::chrono::steady_clock::now();
+    const boost::chrono::steady_clock::time_point deadline =
+        start_wait + boost::chrono::nanoseconds(prewarm_timeout_.toNSec());
+    while (starting_ && started_cv_.wait_until(sl, deadline) == boost::cv_status::no_timeout)
+      ;
+    if (starting_)
+      ROS_WARN_STREAM("" << name_ << " not ready after " << prewarm_timeout_.toSec() << "s; using it anyway");
+    else
+      ROS_DEBUG_STREAM("" << name_ << " ready after waiting "
+                       << boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start_wait).count()
+                       << "s");
+  }
 }
 
 void CostmapWrapper::checkDeactivate()
@@ -117,23 +262,183 @@ void CostmapWrapper::checkDeactivate()
   ROS_ASSERT_MSG(costmap_users_ >= 0, "Negative number (%d) of active users count!", costmap_users_);
   if (shutdown_costmap_ && !costmap_users_)
   {
-    // Delay costmap shutdown by shutdown_costmap_delay so we don't need to enable at each step of a normal
-    // navigation sequence, what is terribly inefficient; the timer is stopped on costmap re-activation and
-    // reset after every new call to deactivate
-    shutdown_costmap_timer_ =
-      private_nh_.createTimer(shutdown_costmap_delay_, &CostmapWrapper::deactivate, this, true);
+    scheduleDeactivate();
   }
 }
 
+void CostmapWrapper::prewarm()
+{
+  boost::mutex::scoped_lock sl(check_costmap_mutex_);
+
+  if (!shutdown_costmap_ || costmap_users_)
+    return;  // always active, or in use already
+
+  if (!active_)
+  {
+    startAsync();
+  }
+  // give the client the whole shutdown delay to start using the costmap, even if it was still active
+  scheduleDeactivate();
+}
+
+void CostmapWrapper::startAsync()
+{
+  ROS_DEBUG_STREAM("Activating " << name_);
+  shutdown_costmap_timer_.stop();
+  active_ = true;
+  active_since_ = ros::WallTime::now();
+  ++activations_;
+  starting_ = true;
+  if (start_thread_.joinable())
+    start_thread_.join();  // previous start thread is done already, or just publishing, as starting_ was false
+  start_thread_ = boost::thread(&CostmapWrapper::startThread, this);
+}
+
+void CostmapWrapper::startThread()
+{
+  start();
+
+  // take the stats before clearing starting_; afterwards, startAsync can join us while holding the lock
+  boost::mutex::scoped_lock sl(check_costmap_mutex_);
+  UsageStats stats;
+  getUsageStatsLocked(stats);
+  starting_ = false;
+  started_cv_.notify_all();
+  ROS_DEBUG_STREAM("" << name_ << " activated");
+  sl.unlock();
+
+  publishUsage(stats);
+}
+
+void CostmapWrapper::scheduleDeactivate()
+{
+  // Delay costmap shutdown by shutdown_costmap_delay so we don't need to enable at each step of a normal
+  // navigation sequence, what is terribly inefficient; the timer is stopped on costmap re-activation and
+  // reset after every new call to deactivate
+  shutdown_costmap_timer_ =
+    private_nh_.createTimer(shutdown_costmap_delay_, &CostmapWrapper::deactivate, this, true);
+}
+
 void CostmapWrapper::deactivate(const ros::TimerEvent &event)
 {
   boost::mutex::scoped_lock sl(check_costmap_mutex_);
 
-  ROS_ASSERT_MSG(!costmap_users_, "Deactivating costmap with %d active users!", costmap_users_);
+  if (costmap_users_ || !active_)
+    return;  // reactivated, or shut down already, since the timer was armed
+
+  if (starting_)
+  {
+    // pre-warmed, but not used; we cannot stop it while starting, so try again later
+    scheduleDeactivate();
+    return;
+  }
+
   if (clear_on_shutdown_)
     clear();  // do before stop, as some layers (e.g. obstacle and voxel) reactivate their subscribers on reset
   stop();
+  active_ = false;
+  active_time_ += ros::WallTime::now() - active_since_;
   ROS_DEBUG_STREAM("" << name_ << " deactivated");
+  UsageStats stats;
+  getUsageStatsLocked(stats);
+  sl.unlock();
+
+  publishUsage(stats, true);
+}
+
+CostmapWrapper::SnapshotPtr CostmapWrapper::getSnapshot()
+{
+  return snapshots_.getSnapshot();
+}
+
+CostmapWrapper::SnapshotPtr CostmapWrapper::getRegionSnapshot(double min_x, double min_y, double max_x, double max_y)
+{
+  return snapshots_.getRegionSnapshot(min_x, min_y, max_x, max_y);
+}
+
+void CostmapWrapper::getUsageStats(UsageStats &stats)
+{
+  boost::mutex::scoped_lock sl(check_costmap_mutex_);
+  getUsageStatsLocked(stats);
+}
+
+void CostmapWrapper::getUsageStatsLocked(UsageStats &stats)
+{
+  const ros::WallTime now = ros::WallTime::now();
+  stats.total_time = (now - created_).toSec();
+  stats.active_time = (active_ ? active_time_ + (now - active_since_) : active_time_).toSec();
+  stats.activations = activations_;
+
+  // the update thread keeps running while the costmap is stopped, but it just sleeps, so its CPU time is spent
+  // almost entirely while active; it's not available if the thread is recreated by reconfiguring the costmap, so we
+  // forget about threads gone, or whose tid has been reused by another thread (its start time differs)
+  stats.update_cpu_time = -1.0;
+  std::map<pid_t, unsigned long long>::iterator thread = update_threads_.begin();
+  while (thread != update_threads_.end())
+  {
+    ThreadInfo info;
+    if (!readThreadInfo(thread->first, info) || info.start_time != thread->second)
+    {
+      update_threads_.erase(thread++);
+      continue;
+    }
+    stats.update_cpu_time = std::max(stats.update_cpu_time, 0.0) + info.cpu_time;
+    ++thread;
+  }
+}
+
+void CostmapWrapper::publishUsage(const UsageStats &stats, bool log)
+{
+  diagnostic_msgs::DiagnosticStatus status;
+  status.level = diagnostic_msgs::DiagnosticStatus::OK;
+  status.name = name_;
+  diagnostic_msgs::KeyValue key_value;
+
+  std::stringstream value;
+  value << std::fixed << std::setprecision(2) << stats.total_time;
+  key_value.key = "total_time";
+  key_value.value = value.str();
+  status.values.push_back(key_value);
+
+  value.str("");
+  value << stats.active_time;
+  key_value.key = "active_time";
+  key_value.value = value.str();
+  status.values.push_back(key_value);
+
+  value.str("");
+  value << stats.activations;
+  key_value.key = "activations";
+  key_value.value = value.str();
+  status.values.push_back(key_value);
+
+  value.str("");
+  if (stats.update_cpu_time >= 0.0)
+    value << stats.update_cpu_time;
+  else
+    value << "n/a";
+  key_value.key = "update_cpu_time";
+  key_value.value = value.str();
+  status.values.push_back(key_value);
+
+  std::stringstream message;
+  message << std::fixed << std::setprecision(1) << name_ << " active "
+          << (stats.total_time > 0.0 ? 100.0 * stats.active_time / stats.total_time : 100.0) << "% of the time ("
+          << stats.active_time << " of " << stats.total_time << " s; " << stats.activations << " activations)";
+  if (stats.update_cpu_time >= 0.0)
+    message << "; update thread used " << stats.update_cpu_time << " s of CPU";
+  status.message = message.str();
+  usage_pub_.publish(status);
+
+  if (log)
+    ROS_INFO_STREAM(status.message);
+}
+
+void CostmapWrapper::publishUsageTimer(const ros::WallTimerEvent &event)
+{
+  UsageStats stats;
+  getUsageStats(stats);
+  publishUsage(stats);
 }
 
 } /* namespace mbf_costmap_nav */
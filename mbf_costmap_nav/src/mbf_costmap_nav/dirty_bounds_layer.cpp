@@ -0,0 +1,102 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  dirty_bounds_layer.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include "mbf_costmap_nav/dirty_bounds_layer.h"
+
+
+namespace mbf_costmap_nav
+{
+
+DirtyBoundsLayer::DirtyBoundsLayer()
+  : all_dirty_(true)
+  , min_i_(std::numeric_limits<int>::max()), min_j_(std::numeric_limits<int>::max())
+  , max_i_(std::numeric_limits<int>::min()), max_j_(std::numeric_limits<int>::min())
+{
+}
+
+void DirtyBoundsLayer::onInitialize()
+{
+  // we never hold back the costmap; otherwise, it would never be current
+  current_ = true;
+  enabled_ = true;
+}
+
+void DirtyBoundsLayer::updateBounds(double robot_x, double robot_y, double robot_yaw,
+                                    double* min_x, double* min_y, double* max_x, double* max_y)
+{
+  // we don't modify the map, so we don't expand the bounds; we get the final ones on updateCosts
+}
+
+void DirtyBoundsLayer::updateCosts(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j)
+{
+  min_i_ = std::min(min_i_, min_i);
+  min_j_ = std::min(min_j_, min_j);
+  max_i_ = std::max(max_i_, max_i);
+  max_j_ = std::max(max_j_, max_j);
+}
+
+void DirtyBoundsLayer::matchSize()
+{
+  all_dirty_ = true;
+}
+
+void DirtyBoundsLayer::reset()
+{
+  all_dirty_ = true;
+}
+
+bool DirtyBoundsLayer::takeDirtyWindow(int& min_i, int& min_j, int& max_i, int& max_j)
+{
+  const bool window = !all_dirty_;
+  min_i = min_i_;
+  min_j = min_j_;
+  max_i = max_i_;
+  max_j = max_j_;
+
+  all_dirty_ = false;
+  min_i_ = min_j_ = std::numeric_limits<int>::max();
+  max_i_ = max_j_ = std::numeric_limits<int>::min();
+  return window;
+}
+
+} /* namespace mbf_costmap_nav */
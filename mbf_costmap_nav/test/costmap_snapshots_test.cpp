@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include <boost/make_shared.hpp>
+
+#include <costmap_2d/layered_costmap.h>
+
+#include "mbf_costmap_nav/costmap_snapshots.h"
+#include "mbf_costmap_nav/dirty_bounds_layer.h"
+
+using mbf_costmap_nav::CostmapSnapshots;
+using mbf_costmap_nav::DirtyBoundsLayer;
+
+// layer writing the costs of a few cells; as real layers, it only expands the update bounds around its changes
+class CellsLayer : public costmap_2d::Layer
+{
+public:
+  void onInitialize()
+  {
+    current_ = true;
+    enabled_ = true;
+  }
+
+  void setCost(unsigned int i, unsigned int j, unsigned char cost)
+  {
+    cells_[std::make_pair(i, j)] = cost;
+    changed_.push_back(std::make_pair(i, j));
+  }
+
+  void updateBounds(double robot_x, double robot_y, double robot_yaw,
+                    double* min_x, double* min_y, double* max_x, double* max_y)
+  {
+    for (size_t c = 0; c < changed_.size(); ++c)
+    {
+      double x, y;
+      layered_costmap_->getCostmap()->mapToWorld(changed_[c].first, changed_[c].second, x, y);
+      *min_x = std::min(*min_x, x);
+      *min_y = std::min(*min_y, y);
+      *max_x = std::max(*max_x, x);
+      *max_y = std::max(*max_y, y);
+    }
+    changed_.clear();
+  }
+
+  void updateCosts(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j)
+  {
+    for (std::map<std::pair<unsigned int, unsigned int>, unsigned char>::const_iterator it = cells_.begin();
+         it != cells_.end(); ++it)
+    {
+      const int i = it->first.first;
+      const int j = it->first.second;
+      if (i >= min_i && i < max_i && j >= min_j && j < max_j)
+        master_grid.setCost(i, j, it->second);
+    }
+  }
+
+private:
+  std::map<std::pair<unsigned int, unsigned int>, unsigned char> cells_;
+  std::vector<std::pair<unsigned int, unsigned int> > changed_;
+};
+
+// 2 x 2 m costmap with 0.1 m cells, and a snapshots manager on top of a single cells layer
+class CostmapSnapshotsTest : public testing::Test
+{
+protected:
+  CostmapSnapshotsTest() : layered_costmap_("map", false, false), cells_layer_(boost::make_shared<CellsLayer>())
+  {
+    layered_costmap_.addPlugin(cells_layer_);
+    cells_layer_->initialize(&layered_costmap_, "cells", NULL);
+    layered_costmap_.resizeMap(20, 20, 0.1, 0.0, 0.0);
+    snapshots_.reset(new CostmapSnapshots(layered_costmap_, "dirty_bounds", NULL));
+  }
+
+  costmap_2d::Costmap2D& costmap()
+  {
+    return *layered_costmap_.getCostmap();
+  }
+
+  costmap_2d::LayeredCostmap layered_costmap_;
+  boost::shared_ptr<CellsLayer> cells_layer_;
+  boost::shared_ptr<CostmapSnapshots> snapshots_;
+};
+
+TEST(DirtyBoundsLayer, dirtyWindow)
+{
+  DirtyBoundsLayer layer;
+  int min_i, min_j, max_i, max_j;
+
+  // everything is dirty until the first window is taken
+  EXPECT_FALSE(layer.takeDirtyWindow(min_i, min_j, max_i, max_j));
+
+  // nothing updated since then: empty window
+  ASSERT_TRUE(layer.takeDirtyWindow(min_i, min_j, max_i, max_j));
+  EXPECT_TRUE(min_i >= max_i && min_j >= max_j);
+
+  // the window covers all the updates since the last one taken
+  costmap_2d::Costmap2D master_grid(20, 20, 0.1, 0.0, 0.0);
+  layer.updateCosts(master_grid, 2, 3, 5, 6);
+  layer.updateCosts(master_grid, 4, 1, 8, 4);
+  ASSERT_TRUE(layer.takeDirtyWindow(min_i, min_j, max_i, max_j));
+  EXPECT_EQ(min_i, 2);
+  EXPECT_EQ(min_j, 1);
+  EXPECT_EQ(max_i, 8);
+  EXPECT_EQ(max_j, 6);
+
+  // resizing or resetting the master grid makes everything dirty again
+  layer.matchSize();
+  EXPECT_FALSE(layer.takeDirtyWindow(min_i, min_j, max_i, max_j));
+  layer.reset();
+  EXPECT_FALSE(layer.takeDirtyWindow(min_i, min_j, max_i, max_j));
+  EXPECT_TRUE(layer.takeDirtyWindow(min_i, min_j, max_i, max_j));
+}
+
+TEST_F(CostmapSnapshotsTest, windowCopy)
+{
+  CostmapSnapshots::SnapshotPtr snapshot = snapshots_->getSnapshot();
+  ASSERT_TRUE(snapshot);
+  EXPECT_EQ(snapshot->getSizeInCellsX(), 20);
+  EXPECT_EQ(snapshot->getSizeInCellsY(), 20);
+  const costmap_2d::Costmap2D* first = snapshot.get();
+  snapshot.reset();
+
+  // a cell changed behind the layers' back is not within the updated window, so it doesn't get copied
+  costmap().setCost(10, 10, 50);
+  cells_layer_->setCost(3, 4, 100);
+  layered_costmap_.updateMap(0.0, 0.0, 0.0);
+
+  // nobody holds the last snapshot, so it gets updated in place
+  snapshot = snapshots_->getSnapshot();
+  ASSERT_EQ(snapshot.get(), first);
+  EXPECT_EQ(snapshot->getCost(3, 4), 100);
+  EXPECT_EQ(snapshot->getCost(10, 10), 0);
+}
+
+TEST_F(CostmapSnapshotsTest, fullCopy)
+{
+  snapshots_->getSnapshot();
+
+  // reset: the whole map is copied
+  layered_costmap_.resetMaps();
+  costmap().setCost(10, 10, 50);
+  CostmapSnapshots::SnapshotPtr snapshot = snapshots_->getSnapshot();
+  EXPECT_EQ(snapshot->getCost(10, 10), 50);
+  snapshot.reset();
+
+  // resize: the snapshot gets the new size
+  layered_costmap_.resizeMap(30, 25, 0.1, 0.0, 0.0);
+  costmap().setCost(25, 20, 60);
+  snapshot = snapshots_->getSnapshot();
+  EXPECT_EQ(snapshot->getSizeInCellsX(), 30);
+  EXPECT_EQ(snapshot->getSizeInCellsY(), 25);
+  EXPECT_EQ(snapshot->getCost(25, 20), 60);
+  snapshot.reset();
+
+  // origin change, as on rolling window costmaps; the layers are not told, so it's just the origin we check
+  costmap().updateOrigin(1.0, 0.5);
+  costmap().setCost(0, 0, 70);
+  snapshot = snapshots_->getSnapshot();
+  EXPECT_DOUBLE_EQ(snapshot->getOriginX(), 1.0);
+  EXPECT_DOUBLE_EQ(snapshot->getOriginY(), 0.5);
+  EXPECT_EQ(snapshot->getCost(0, 0), 70);
+}
+
+TEST_F(CostmapSnapshotsTest, snapshotInUse)
+{
+  const CostmapSnapshots::SnapshotPtr held = snapshots_->getSnapshot();
+
+  cells_layer_->setCost(5, 5, 200);
+  layered_costmap_.updateMap(0.0, 0.0, 0.0);
+
+  // the held snapshot must remain untouched, so we get a copy with the changes applied
+  const CostmapSnapshots::SnapshotPtr snapshot = snapshots_->getSnapshot();
+  ASSERT_NE(snapshot.get(), held.get());
+  EXPECT_EQ(snapshot->getCost(5, 5), 200);
+  EXPECT_EQ(held->getCost(5, 5), 0);
+
+  // and further changes are applied just to the latest one
+  cells_layer_->setCost(6, 6, 150);
+  layered_costmap_.updateMap(0.0, 0.0, 0.0);
+  const CostmapSnapshots::SnapshotPtr latest = snapshots_->getSnapshot();
+  EXPECT_EQ(latest->getCost(5, 5), 200);
+  EXPECT_EQ(latest->getCost(6, 6), 150);
+  EXPECT_EQ(snapshot->getCost(6, 6), 0);
+  EXPECT_EQ(held->getCost(6, 6), 0);
+}
+
+TEST_F(CostmapSnapshotsTest, regionSnapshot)
+{
+  costmap().setCost(5, 6, 80);
+  costmap().setCost(19, 19, 90);
+
+  // a region reaching beyond the upper bounds is cropped to the last cells, and aligned to the costmap cells
+  CostmapSnapshots::SnapshotPtr snapshot = snapshots_->getRegionSnapshot(0.55, 0.62, 5.0, 5.0);
+  ASSERT_TRUE(snapshot);
+  EXPECT_EQ(snapshot->getSizeInCellsX(), 15);
+  EXPECT_EQ(snapshot->getSizeInCellsY(), 14);
+  EXPECT_NEAR(snapshot->getOriginX(), 0.5, 1e-9);
+  EXPECT_NEAR(snapshot->getOriginY(), 0.6, 1e-9);
+  EXPECT_DOUBLE_EQ(snapshot->getResolution(), 0.1);
+  EXPECT_EQ(snapshot->getCost(0, 0), 80);
+  EXPECT_EQ(snapshot->getCost(14, 13), 90);
+
+  // the cells containing the region corners are included
+  snapshot = snapshots_->getRegionSnapshot(0.55, 0.65, 0.55, 0.65);
+  ASSERT_TRUE(snapshot);
+  EXPECT_EQ(snapshot->getSizeInCellsX(), 1);
+  EXPECT_EQ(snapshot->getSizeInCellsY(), 1);
+  EXPECT_EQ(snapshot->getCost(0, 0), 80);
+
+  // regions outside the costmap, or inverted, give no snapshot
+  EXPECT_FALSE(snapshots_->getRegionSnapshot(3.0, 3.0, 4.0, 4.0));
+  EXPECT_FALSE(snapshots_->getRegionSnapshot(-2.0, 0.0, -1.0, 1.0));
+  EXPECT_FALSE(snapshots_->getRegionSnapshot(1.0, 1.0, 0.5, 0.5));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -42,6 +42,9 @@
 #define MBF_UTILITY__NAVIGATION_UTILITY_H_
 
 #include <geometry_msgs/PoseStamped.h>
+#include <geometry_msgs/Twist.h>
+#include <mbf_msgs/CompactFeedback.h>
+#include <mbf_msgs/ExePathFeedback.h>
 #include <ros/duration.h>
 #include <ros/time.h>
 #include <string>
@@ -49,6 +52,7 @@
 #include <tf2_ros/buffer.h>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.h>
 
+#include "mbf_utility/pose_math.h"
 #include "mbf_utility/types.h"
 
 namespace mbf_utility
@@ -99,20 +103,16 @@ bool getRobotPose(const TF &tf,
                   const ros::Duration &timeout,
                   geometry_msgs::PoseStamped &robot_pose);
 /**
- * @brief Computes the Euclidean-distance between two poses.
- * @param pose1 pose 1
- * @param pose2 pose 2
- * @return Euclidean distance between pose 1 and pose 2.
+ * @brief Predicts the pose some time ahead, integrating a velocity assumed constant over that time.
+ * @param pose Initial pose
+ * @param velocity Velocity, given on the frame of the moving pose (as on odometry messages)
+ * @param horizon How far ahead to predict the pose; can be negative, to predict backwards
+ * @param predicted_pose The predicted pose, stamped horizon after the initial one
  */
-double distance(const geometry_msgs::PoseStamped &pose1, const geometry_msgs::PoseStamped &pose2);
-
-/**
- * @brief Computes the smallest angle between two poses.
- * @param pose1 pose 1
- * @param pose2 pose 2
- * @return smallest angle between pose 1 and pose 2.
- */
-double angle(const geometry_msgs::PoseStamped &pose1, const geometry_msgs::PoseStamped &pose2);
+void predictPose(const geometry_msgs::PoseStamped &pose,
+                 const geometry_msgs::Twist &velocity,
+                 const ros::Duration &horizon,
+                 geometry_msgs::PoseStamped &predicted_pose);
 
 /**
  * @brief Get a descriptive string for each possible MBF action outcome.
@@ -121,6 +121,15 @@ double angle(const geometry_msgs::PoseStamped &pose1, const geometry_msgs::PoseS
  */
 std::string outcome2str(unsigned int outcome);
 
+/**
+ * @brief Fills the compact version of an exe_path feedback, for clients on constrained links.
+ * @param feedback The full exe_path feedback
+ * @param concurrency_slot Concurrency slot of the exe_path goal
+ * @param compact_feedback The compact feedback
+ */
+void toCompactFeedback(const mbf_msgs::ExePathFeedback &feedback, uint8_t concurrency_slot,
+                       mbf_msgs::CompactFeedback &compact_feedback);
+
 } /* namespace mbf_utility */
 
 #endif /* MBF_UTILITY__NAVIGATION_UTILITY_H_ */
@@ -38,18 +38,50 @@
 #ifndef ODOMETRY_HELPER_H_
 #define ODOMETRY_HELPER_H_
 
+#include <atomic>
+
 #include <nav_msgs/Odometry.h>
 #include <ros/ros.h>
 #include <boost/thread.hpp>
 #include <geometry_msgs/PoseStamped.h>
+#include <geometry_msgs/Twist.h>
 
 namespace mbf_utility
 {
 
+/**
+ * @brief The odometry fields we use, without the pose and the covariances of the full message.
+ */
+struct OdometryState
+{
+  OdometryState() : seq(0) {}
+
+  uint32_t seq;                ///< Sequence number of the odometry message
+  ros::Time stamp;             ///< Stamp of the odometry message, or reception time if it had none
+  geometry_msgs::Twist twist;  ///< Robot velocity, given on the robot frame
+};
+
+/**
+ * @brief Statistics of the robot velocity over a time window.
+ */
+struct VelocityStats
+{
+  VelocityStats() : samples(0), mean_linear(0.0), max_linear(0.0), mean_angular(0.0), max_angular(0.0) {}
+
+  size_t samples;       ///< Number of odometry samples within the window
+  double mean_linear;   ///< Mean translational speed
+  double max_linear;    ///< Maximum translational speed
+  double mean_angular;  ///< Mean absolute rotational speed
+  double max_angular;   ///< Maximum absolute rotational speed
+};
+
 class OdometryHelper
 {
 public:
 
+  //! number of odometry samples kept on the history
+  static const size_t HISTORY_SIZE = 256;
+
   /** @brief Constructor.
    * @param odom_topic The topic on which to subscribe to Odometry
    *        messages.  If the empty string is given (the default), no
@@ -58,6 +90,45 @@ public:
   OdometryHelper(const std::string& odom_topic = "");
   ~OdometryHelper() {}
 
+  /**
+   * @brief Reads the latest odometry state without locking, so readers never contend with the odometry callback.
+   * @param state The latest odometry state; zero stamped if no odometry has been received yet
+   */
+  void getOdomState(OdometryState& state) const;
+
+  /**
+   * @brief Interpolates the odometry state at the given time from the history, without locking.
+   * @param stamp Time to look up; times newer than the latest sample get the latest one
+   * @param state The odometry state at the given time
+   * @return false if there's no odometry yet, or the time is older than the history
+   */
+  bool getOdomStateAt(const ros::Time& stamp, OdometryState& state) const;
+
+  /**
+   * @brief Computes statistics of the velocity over the samples within a time window, without locking.
+   * @param window Time window, back from the latest sample
+   * @param stats Velocity statistics; zero samples if there's no odometry yet
+   */
+  void getVelocityStats(const ros::Duration& window, VelocityStats& stats) const;
+
+  /**
+   * @brief Returns the frame of the latest odometry message.
+   */
+  std::string getOdomFrame() const;
+
+  /**
+   * @brief Enables keeping a pointer to the latest odometry message, for users needing the full message. Disabled
+   *        by default, as we only keep the fields in OdometryState otherwise.
+   * @param retain Whether to keep the latest odometry message
+   */
+  void setRetainMessage(bool retain);
+
+  /**
+   * @brief Returns the latest odometry message, without copying it. Requires enabling setRetainMessage.
+   * @return The latest odometry message, or an empty pointer if none is retained
+   */
+  nav_msgs::Odometry::ConstPtr getOdomMessage() const;
+
   /**
    * @brief Callback for receiving odometry data
    * @param msg An Odometry message
@@ -65,7 +136,8 @@ public:
   void odomCallback(const nav_msgs::Odometry::ConstPtr& msg);
 
   /**
-   * @brief Copy over the  information
+   * @brief Copy over the  information. Unless setRetainMessage is enabled, only the fields in OdometryState and
+   *        the frame are filled; prefer getOdomState, which doesn't lock.
    * @param base_odom Copied odometry msg
    */
   void getOdom(nav_msgs::Odometry& base_odom) const;
@@ -87,8 +159,46 @@ private:
 
   // we listen on odometry on the odom topic
   ros::Subscriber odom_sub_;
-  nav_msgs::Odometry base_odom_;
-  mutable boost::mutex odom_mutex_;
+
+  // serializes the odometry callbacks, in case of multi-threaded spinners; readers never lock it
+  boost::mutex write_mutex_;
+
+  // one sample on the odometry history, protected by its own seqlock: the version is odd while the callback
+  // writes it, so readers retry. Fields are relaxed atomics, so a torn read is just retried instead of being
+  // undefined behavior
+  struct HistorySlot
+  {
+    HistorySlot();
+
+    std::atomic<uint32_t> version;
+    std::atomic<uint64_t> index;  // number of the sample stored in the slot
+    std::atomic<uint32_t> seq;
+    std::atomic<int64_t> stamp;
+    std::atomic<double> twist[6];
+  };
+
+  /**
+   * @brief Reads a sample from the history, without locking.
+   * @param index Number of the sample to read
+   * @param state The sample read
+   * @return false if the sample has already been overwritten by a newer one
+   */
+  bool readSample(uint64_t index, OdometryState& state) const;
+
+  // ring buffer with the latest odometry samples; the latest one is at (history_count_ - 1) % HISTORY_SIZE
+  HistorySlot history_[HISTORY_SIZE];
+
+  // number of odometry samples received
+  std::atomic<uint64_t> history_count_;
+
+  // frame of the latest odometry message; only locked by the callback when it changes
+  std::string odom_frame_;
+  mutable boost::mutex frame_mutex_;
+
+  // latest odometry message, if retained
+  bool retain_message_;
+  nav_msgs::Odometry::ConstPtr odom_msg_;
+  mutable boost::mutex msg_mutex_;
 };
 
 } /* namespace mbf_utility */
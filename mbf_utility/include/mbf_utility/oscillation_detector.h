@@ -0,0 +1,162 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  oscillation_detector.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_UTILITY__OSCILLATION_DETECTOR_H_
+#define MBF_UTILITY__OSCILLATION_DETECTOR_H_
+
+#include <deque>
+
+#include <geometry_msgs/PoseStamped.h>
+#include <ros/duration.h>
+#include <ros/time.h>
+
+namespace mbf_utility
+{
+
+/**
+ * @brief Detects a robot oscillating, i.e. not making progress, from the history of its poses over a time window
+ *        as long as the oscillation timeout. The robot makes progress if, within the window, it either rotates more
+ *        than the oscillation angle, or it moves more than the oscillation distance and, optionally, this net
+ *        displacement is not much shorter than the path it traveled to achieve it. The latter catches back-and-forth
+ *        motions that never stay long enough within the oscillation distance of a single reference pose.
+ *        The path length over the window is updated incrementally, so each update is O(1) amortized.
+ *        Not thread safe; each user should keep its own instance.
+ */
+class OscillationDetector
+{
+ public:
+
+  /**
+   * @brief Constructor
+   * @param timeout How long the robot may not progress before we consider it oscillating; zero disables detection
+   * @param distance Minimum net displacement over the timeout to count as progress
+   * @param angle Minimum net rotation over the timeout to count as progress
+   * @param min_path_efficiency Minimum ratio between net displacement and traveled path over the timeout for a
+   *        translation to count as progress; zero disables this check
+   */
+  OscillationDetector(const ros::Duration &timeout = ros::Duration(0), double distance = 0.0, double angle = 0.0,
+                      double min_path_efficiency = 0.0);
+
+  /**
+   * @brief Changes the detection parameters, and resets the pose history.
+   * @param timeout How long the robot may not progress before we consider it oscillating; zero disables detection
+   * @param distance Minimum net displacement over the timeout to count as progress
+   * @param angle Minimum net rotation over the timeout to count as progress
+   * @param min_path_efficiency Minimum ratio between net displacement and traveled path over the timeout for a
+   *        translation to count as progress; zero disables this check
+   */
+  void setParams(const ros::Duration &timeout, double distance, double angle, double min_path_efficiency = 0.0);
+
+  /**
+   * @brief Whether oscillation detection is enabled, i.e. the timeout is not zero.
+   */
+  bool isEnabled() const;
+
+  /**
+   * @brief Clears the pose history, so the robot gets a whole timeout before being considered oscillating again.
+   */
+  void reset();
+
+  /**
+   * @brief Adds a new robot pose to the history and evaluates whether the robot is oscillating.
+   * @param pose Current robot pose
+   * @param stamp Time of the update; poses received with a same stamp or older than the last one are ignored
+   * @return true if the robot has not made progress over a whole timeout; always false if detection is disabled
+   */
+  bool update(const geometry_msgs::PoseStamped &pose, const ros::Time &stamp = ros::Time::now());
+
+  /**
+   * @brief Whether the robot made progress over the window as of the last update, even if it doesn't span a whole
+   *        timeout yet. Useful to notice that the robot has recovered from an oscillation.
+   */
+  bool isProgressing() const;
+
+  /**
+   * @brief Time spanned by the pose history; after a detection, it's how long the robot has been oscillating.
+   */
+  ros::Duration getWindowDuration() const;
+
+  /**
+   * @brief Distance between the oldest and newest poses on the history.
+   */
+  double getNetDistance() const;
+
+  /**
+   * @brief Length of the path traveled by the robot over the history.
+   */
+  double getPathLength() const;
+
+ private:
+
+  struct Sample
+  {
+    geometry_msgs::PoseStamped pose;
+    ros::Time stamp;
+    double segment_length;  ///< Distance from the previous sample
+  };
+
+  //! how long the robot may not progress before we consider it oscillating
+  ros::Duration timeout_;
+
+  //! minimal net displacement to not detect an oscillation
+  double distance_;
+
+  //! minimal net rotation to not detect an oscillation
+  double angle_;
+
+  //! minimal ratio between net displacement and traveled path to not detect an oscillation
+  double min_path_efficiency_;
+
+  //! robot poses over the last timeout; the oldest one is the last sample at or before the start of the window
+  std::deque<Sample> window_;
+
+  //! length of the path between the oldest and newest samples on the window
+  double path_length_;
+
+  //! whether the robot made progress over the window as of the last update
+  bool progressing_;
+
+  //! whether the robot was oscillating as of the last update
+  bool oscillating_;
+};
+
+} /* namespace mbf_utility */
+
+#endif /* MBF_UTILITY__OSCILLATION_DETECTOR_H_ */
@@ -0,0 +1,147 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  path_progress_tracker.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_UTILITY__PATH_PROGRESS_TRACKER_H_
+#define MBF_UTILITY__PATH_PROGRESS_TRACKER_H_
+
+#include <vector>
+
+#include <geometry_msgs/Point.h>
+#include <geometry_msgs/PoseStamped.h>
+
+namespace mbf_utility
+{
+
+/**
+ * @brief Tracks the progress of the robot along a path: the segment it's on and the path length still ahead.
+ *        The first update searches the whole path for the nearest segment; afterwards, we only search forward,
+ *        within a lookahead distance of the current position along the path, so each update costs amortized O(1)
+ *        regardless of the path length. We never go back to previous segments, so looping or self-crossing paths
+ *        don't make us jump to an earlier lap, and the lookahead prevents jumping to a later one.
+ *        Not thread safe; users must serialize setPath and update calls.
+ */
+class PathProgressTracker
+{
+ public:
+
+  /**
+   * @brief Constructor
+   * @param lookahead How far ahead along the path we search for the nearest segment on each update. It must
+   *        be longer than what the robot can travel between updates, or we will lag behind it
+   */
+  PathProgressTracker(double lookahead = 1.0);
+
+  /**
+   * @brief Starts tracking a new path; precomputes its cumulative arc length, in O(path size).
+   * @param path The path to track
+   */
+  void setPath(const std::vector<geometry_msgs::PoseStamped> &path);
+
+  /**
+   * @brief Clears the tracked path.
+   */
+  void clear();
+
+  /**
+   * @brief Updates the progress with the current robot pose, projecting it on the nearest segment ahead.
+   * @param pose Current robot pose, on the same frame as the path
+   * @return false if there's no path to track
+   */
+  bool update(const geometry_msgs::PoseStamped &pose);
+
+  /**
+   * @brief Index of the segment the robot is on, i.e. of its first pose.
+   */
+  size_t getSegmentIndex() const;
+
+  /**
+   * @brief Path length from the robot projection on the path to its end.
+   */
+  double getRemainingLength() const;
+
+  /**
+   * @brief Path length from its start to the robot projection on it.
+   */
+  double getTraveledLength() const;
+
+  /**
+   * @brief Total length of the path.
+   */
+  double getPathLength() const;
+
+  /**
+   * @brief Distance from the robot to its projection on the path.
+   */
+  double getDistanceToPath() const;
+
+ private:
+
+  /**
+   * @brief Projects a point on a segment of the path.
+   * @param segment Index of the segment
+   * @param point The point to project
+   * @param fraction Position of the projection along the segment, in [0, 1]
+   * @return squared distance from the point to its projection
+   */
+  double project(size_t segment, const geometry_msgs::Point &point, double &fraction) const;
+
+  //! how far ahead along the path we search for the nearest segment
+  double lookahead_;
+
+  //! positions of the path poses; we don't need the orientations
+  std::vector<geometry_msgs::Point> points_;
+
+  //! arc length from the start of the path to each of its poses
+  std::vector<double> arc_length_;
+
+  //! whether we have updated at least once since the path was set
+  bool initialized_;
+
+  //! current segment, and position of the robot projection along it, in [0, 1]
+  size_t segment_;
+  double fraction_;
+
+  //! distance from the robot to its projection
+  double distance_;
+};
+
+} /* namespace mbf_utility */
+
+#endif /* MBF_UTILITY__PATH_PROGRESS_TRACKER_H_ */
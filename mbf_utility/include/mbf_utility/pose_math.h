@@ -0,0 +1,282 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  pose_math.h
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#ifndef MBF_UTILITY__POSE_MATH_H_
+#define MBF_UTILITY__POSE_MATH_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include <geometry_msgs/Point.h>
+#include <geometry_msgs/PoseStamped.h>
+#include <geometry_msgs/Quaternion.h>
+
+/**
+ * Inlined pose math used on every control cycle, working directly on the message types. Equivalent to converting
+ * to tf types and using their methods, but without the conversions, copies and normalization on the common case.
+ */
+namespace mbf_utility
+{
+
+/**
+ * @brief Computes the squared Euclidean distance between two points; enough to compare distances, without a sqrt.
+ * @param p1 point 1
+ * @param p2 point 2
+ * @return squared Euclidean distance between point 1 and point 2
+ */
+inline double squaredDistance(const geometry_msgs::Point &p1, const geometry_msgs::Point &p2)
+{
+  const double dx = p1.x - p2.x;
+  const double dy = p1.y - p2.y;
+  const double dz = p1.z - p2.z;
+  return dx * dx + dy * dy + dz * dz;
+}
+
+/**
+ * @brief Computes the Euclidean-distance between two poses.
+ * @param pose1 pose 1
+ * @param pose2 pose 2
+ * @return Euclidean distance between pose 1 and pose 2.
+ */
+inline double distance(const geometry_msgs::PoseStamped &pose1, const geometry_msgs::PoseStamped &pose2)
+{
+  return std::sqrt(squaredDistance(pose1.pose.position, pose2.pose.position));
+}
+
+/**
+ * @brief Whether a quaternion is a rotation around the z axis only, as those of planar robots.
+ *        Quaternions created from a yaw have exact zeros on x and y, so no tolerance is needed.
+ * @param q quaternion
+ * @return true if the quaternion only rotates around the z axis
+ */
+inline bool isPlanar(const geometry_msgs::Quaternion &q)
+{
+  return q.x == 0.0 && q.y == 0.0;
+}
+
+/**
+ * @brief Computes the rotation angle between two quaternions from their dot product, scaled by their norms.
+ *        Zero quaternions, as on default-constructed messages, are taken as the identity.
+ * @param dot dot product of the quaternions
+ * @param norm1 squared norm of quaternion 1
+ * @param norm2 squared norm of quaternion 2
+ * @param w1 w component of quaternion 1
+ * @param w2 w component of quaternion 2
+ * @return smallest angle between the quaternions, in [0, pi]
+ */
+inline double angleFromDot(double dot, double norm1, double norm2, double w1, double w2)
+{
+  // the dot product with the identity is just the w component of the other quaternion
+  if (norm1 == 0.0)
+  {
+    if (norm2 == 0.0)
+    {
+      return 0.0;
+    }
+    dot = w2;
+    norm1 = 1.0;
+  }
+  else if (norm2 == 0.0)
+  {
+    dot = w1;
+    norm2 = 1.0;
+  }
+  // most quaternions come normalized, so we skip the sqrt unless they aren't
+  const double norm = norm1 * norm2;
+  if (std::fabs(norm - 1.0) > 1e-9)
+  {
+    dot /= std::sqrt(norm);
+  }
+  return 2.0 * std::acos(std::min(std::fabs(dot), 1.0));
+}
+
+/**
+ * @brief Computes the smallest angle between two rotations around the z axis; x and y components are ignored.
+ * @param q1 quaternion 1
+ * @param q2 quaternion 2
+ * @return smallest angle between quaternion 1 and quaternion 2, in [0, pi]
+ */
+inline double planarAngle(const geometry_msgs::Quaternion &q1, const geometry_msgs::Quaternion &q2)
+{
+  return angleFromDot(q1.z * q2.z + q1.w * q2.w,
+                      q1.z * q1.z + q1.w * q1.w, q2.z * q2.z + q2.w * q2.w, q1.w, q2.w);
+}
+
+/**
+ * @brief Computes the smallest angle between two 3D rotations.
+ * @param q1 quaternion 1
+ * @param q2 quaternion 2
+ * @return smallest angle between quaternion 1 and quaternion 2, in [0, pi]
+ */
+inline double angle3D(const geometry_msgs::Quaternion &q1, const geometry_msgs::Quaternion &q2)
+{
+  return angleFromDot(q1.x * q2.x + q1.y * q2.y + q1.z * q2.z + q1.w * q2.w,
+                      q1.x * q1.x + q1.y * q1.y + q1.z * q1.z + q1.w * q1.w,
+                      q2.x * q2.x + q2.y * q2.y + q2.z * q2.z + q2.w * q2.w, q1.w, q2.w);
+}
+
+/**
+ * @brief Computes the smallest angle between two rotations, taking the planar path if both are around z only.
+ * @param q1 quaternion 1
+ * @param q2 quaternion 2
+ * @return smallest angle between quaternion 1 and quaternion 2, in [0, pi]
+ */
+inline double angle(const geometry_msgs::Quaternion &q1, const geometry_msgs::Quaternion &q2)
+{
+  return isPlanar(q1) && isPlanar(q2) ? planarAngle(q1, q2) : angle3D(q1, q2);
+}
+
+/**
+ * @brief Computes the yaw of a quaternion, i.e. its rotation around the z axis.
+ * @param q quaternion
+ * @return yaw angle, in [-pi, pi]
+ */
+inline double yaw(const geometry_msgs::Quaternion &q)
+{
+  return std::atan2(2.0 * (q.w * q.z + q.x * q.y), 1.0 - 2.0 * (q.y * q.y + q.z * q.z));
+}
+
+/**
+ * @brief Computes the smallest angle between two poses.
+ * @param pose1 pose 1
+ * @param pose2 pose 2
+ * @return smallest angle between pose 1 and pose 2.
+ */
+inline double angle(const geometry_msgs::PoseStamped &pose1, const geometry_msgs::PoseStamped &pose2)
+{
+  return angle(pose1.pose.orientation, pose2.pose.orientation);
+}
+
+/**
+ * @brief Computes the distance from each pose of an array to a reference pose.
+ * @param poses The poses
+ * @param reference The reference pose
+ * @param distances Distance from each pose to the reference, in the same order
+ */
+inline void distances(const std::vector<geometry_msgs::PoseStamped> &poses,
+                      const geometry_msgs::PoseStamped &reference,
+                      std::vector<double> &distances)
+{
+  distances.resize(poses.size());
+  for (size_t i = 0; i < poses.size(); ++i)
+  {
+    distances[i] = distance(poses[i], reference);
+  }
+}
+
+/**
+ * @brief Computes the angle from each pose of an array to a reference pose.
+ * @param poses The poses
+ * @param reference The reference pose
+ * @param angles Angle from each pose to the reference, in the same order
+ */
+inline void angles(const std::vector<geometry_msgs::PoseStamped> &poses,
+                   const geometry_msgs::PoseStamped &reference,
+                   std::vector<double> &angles)
+{
+  angles.resize(poses.size());
+  const geometry_msgs::Quaternion &q = reference.pose.orientation;
+  if (isPlanar(q))
+  {
+    for (size_t i = 0; i < poses.size(); ++i)
+    {
+      const geometry_msgs::Quaternion &qi = poses[i].pose.orientation;
+      angles[i] = isPlanar(qi) ? planarAngle(qi, q) : angle3D(qi, q);
+    }
+  }
+  else
+  {
+    for (size_t i = 0; i < poses.size(); ++i)
+    {
+      angles[i] = angle3D(poses[i].pose.orientation, q);
+    }
+  }
+}
+
+/**
+ * @brief Finds the pose of an array closest to a reference pose, comparing squared distances.
+ * @param poses The poses
+ * @param reference The reference pose
+ * @return index of the closest pose; 0 if the array is empty
+ */
+inline size_t closestPose(const std::vector<geometry_msgs::PoseStamped> &poses,
+                          const geometry_msgs::PoseStamped &reference)
+{
+  size_t closest = 0;
+  double min_dist2 = std::numeric_limits<double>::infinity();
+  for (size_t i = 0; i < poses.size(); ++i)
+  {
+    const double dist2 = squaredDistance(poses[i].pose.position, reference.pose.position);
+    if (dist2 < min_dist2)
+    {
+      min_dist2 = dist2;
+      closest = i;
+    }
+  }
+  return closest;
+}
+
+/**
+ * @brief Computes the length of the path through a range of poses.
+ * @param begin Iterator to the first pose
+ * @param end Iterator past the last pose
+ * @return length of the path; 0 if it has less than two poses
+ */
+template <typename Iter>
+inline double pathLength(Iter begin, Iter end)
+{
+  double length = 0.0;
+  if (begin == end)
+  {
+    return length;
+  }
+  for (Iter next = begin + 1; next != end; ++begin, ++next)
+  {
+    length += distance(*begin, *next);
+  }
+  return length;
+}
+
+} /* namespace mbf_utility */
+
+#endif /* MBF_UTILITY__POSE_MATH_H_ */
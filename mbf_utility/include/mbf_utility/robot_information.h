@@ -78,13 +78,33 @@ class RobotInformation
    */
   bool getRobotVelocity(geometry_msgs::TwistStamped &robot_velocity) const;
 
+  /**
+   * @brief Returns the robot velocity at the given time, interpolated from the odometry history. Useful to get the
+   *        velocity consistent with a pose, using the pose's stamp.
+   * @param stamp Time at which we want the robot velocity
+   * @param robot_velocity Reference to the robot_velocity message object to be filled.
+   * @return true, if the robot velocity at the given time could be obtained, false otherwise.
+   */
+  bool getRobotVelocity(const ros::Time &stamp, geometry_msgs::TwistStamped &robot_velocity) const;
+
+  /**
+   * @brief Computes statistics of the robot velocity over the latest odometry samples.
+   * @param window Time window, back from the latest odometry sample
+   * @param stats Velocity statistics
+   * @return true, if there are odometry samples, false otherwise.
+   */
+  bool getRobotVelocityStats(const ros::Duration &window, VelocityStats &stats) const;
+
   /**
    * @brief Check whether the robot is stopped or not
    * @param rot_stopped_velocity The rotational velocity below which the robot is considered stopped
    * @param trans_stopped_velocity The translational velocity below which the robot is considered stopped
+   * @param window If not zero, the robot must be stopped on all the odometry samples within this time window, back
+   *        from the latest one, so a single sample doesn't tell it's stopped
    * @return true if the robot is stopped, false otherwise
    */
-  bool isRobotStopped(double rot_stopped_velocity, double trans_stopped_velocity) const;
+  bool isRobotStopped(double rot_stopped_velocity, double trans_stopped_velocity,
+                      const ros::Duration &window = ros::Duration(0)) const;
 
   const std::string& getGlobalFrame() const;
 
@@ -195,24 +195,33 @@ bool transformPoint(const TF &tf,
   return true;
 }
 
-double distance(const geometry_msgs::PoseStamped &pose1, const geometry_msgs::PoseStamped &pose2)
+void predictPose(const geometry_msgs::PoseStamped &pose,
+                 const geometry_msgs::Twist &velocity,
+                 const ros::Duration &horizon,
+                 geometry_msgs::PoseStamped &predicted_pose)
 {
-  const geometry_msgs::Point &p1 = pose1.pose.position;
-  const geometry_msgs::Point &p2 = pose2.pose.position;
-  const double dx = p1.x - p2.x;
-  const double dy = p1.y - p2.y;
-  const double dz = p1.z - p2.z;
-  return sqrt(dx * dx + dy * dy + dz * dz);
-}
-
-double angle(const geometry_msgs::PoseStamped &pose1, const geometry_msgs::PoseStamped &pose2)
-{
-  const geometry_msgs::Quaternion &q1 = pose1.pose.orientation;
-  const geometry_msgs::Quaternion &q2 = pose2.pose.orientation;
-  tf::Quaternion rot1, rot2;
-  tf::quaternionMsgToTF(q1, rot1);
-  tf::quaternionMsgToTF(q2, rot2);
-  return rot1.angleShortestPath(rot2);
+  // integrate the velocity, given on the moving frame, along a circular arc (or a straight line if not turning)
+  const double dt = horizon.toSec();
+  const double yaw = tf::getYaw(pose.pose.orientation);
+  const double delta_yaw = velocity.angular.z * dt;
+  double dx, dy;
+  if (std::abs(velocity.angular.z) < 1e-6)
+  {
+    dx = velocity.linear.x * dt;
+    dy = velocity.linear.y * dt;
+  }
+  else
+  {
+    dx = (velocity.linear.x * std::sin(delta_yaw) + velocity.linear.y * (std::cos(delta_yaw) - 1.0)) /
+         velocity.angular.z;
+    dy = (velocity.linear.x * (1.0 - std::cos(delta_yaw)) + velocity.linear.y * std::sin(delta_yaw)) /
+         velocity.angular.z;
+  }
+  predicted_pose = pose;
+  predicted_pose.pose.position.x += dx * std::cos(yaw) - dy * std::sin(yaw);
+  predicted_pose.pose.position.y += dx * std::sin(yaw) + dy * std::cos(yaw);
+  predicted_pose.pose.orientation = tf::createQuaternionMsgFromYaw(yaw + delta_yaw);
+  predicted_pose.header.stamp += horizon;
 }
 
 std::string outcome2str(unsigned int outcome)
@@ -339,4 +348,21 @@ std::string outcome2str(unsigned int outcome)
   return "Unknown error code";
 }
 
+void toCompactFeedback(const mbf_msgs::ExePathFeedback &feedback, uint8_t concurrency_slot,
+                       mbf_msgs::CompactFeedback &compact_feedback)
+{
+  compact_feedback.stamp = feedback.last_cmd_vel.header.stamp;
+  compact_feedback.concurrency_slot = concurrency_slot;
+  compact_feedback.outcome = static_cast<uint8_t>(feedback.outcome);
+  compact_feedback.dist_to_goal = feedback.dist_to_goal;
+  compact_feedback.angle_to_goal = feedback.angle_to_goal;
+  compact_feedback.remaining_path_length = feedback.remaining_path_length;
+  compact_feedback.x = static_cast<float>(feedback.current_pose.pose.position.x);
+  compact_feedback.y = static_cast<float>(feedback.current_pose.pose.position.y);
+  compact_feedback.yaw = static_cast<float>(yaw(feedback.current_pose.pose.orientation));
+  compact_feedback.vel_x = static_cast<float>(feedback.last_cmd_vel.twist.linear.x);
+  compact_feedback.vel_y = static_cast<float>(feedback.last_cmd_vel.twist.linear.y);
+  compact_feedback.vel_yaw = static_cast<float>(feedback.last_cmd_vel.twist.angular.z);
+}
+
 } /* namespace mbf_utility */
@@ -34,12 +34,23 @@
  *
  * Author: TKruse
  *********************************************************************/
+#include <algorithm>
+#include <cmath>
+
 #include <mbf_utility/odometry_helper.h>
 
 namespace mbf_utility
 {
 
-OdometryHelper::OdometryHelper(const std::string& odom_topic)
+const size_t OdometryHelper::HISTORY_SIZE;
+
+OdometryHelper::HistorySlot::HistorySlot() : version(0), index(0), seq(0), stamp(0)
+{
+  for (int i = 0; i < 6; ++i)
+    twist[i].store(0.0, std::memory_order_relaxed);
+}
+
+OdometryHelper::OdometryHelper(const std::string& odom_topic) : history_count_(0), retain_message_(false)
 {
   setOdomTopic(odom_topic);
 }
@@ -49,16 +60,209 @@ void OdometryHelper::odomCallback(const nav_msgs::Odometry::ConstPtr& msg)
   ROS_INFO_STREAM_ONCE("Odometry received on topic " << getOdomTopic());
 
   // we assume that the odometry is published in the frame of the base
-  boost::mutex::scoped_lock lock(odom_mutex_);
-  base_odom_ = *msg;
-  if (base_odom_.header.stamp.isZero())
-    base_odom_.header.stamp = ros::Time::now();
+  const ros::Time stamp = msg->header.stamp.isZero() ? ros::Time::now() : msg->header.stamp;
+  const geometry_msgs::Twist& twist = msg->twist.twist;
+
+  boost::mutex::scoped_lock lock(write_mutex_);
+
+  const uint64_t index = history_count_.load(std::memory_order_relaxed);
+  HistorySlot& slot = history_[index % HISTORY_SIZE];
+  const uint32_t version = slot.version.load(std::memory_order_relaxed);
+  slot.version.store(version + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.index.store(index, std::memory_order_relaxed);
+  slot.seq.store(msg->header.seq, std::memory_order_relaxed);
+  slot.stamp.store(stamp.toNSec(), std::memory_order_relaxed);
+  slot.twist[0].store(twist.linear.x, std::memory_order_relaxed);
+  slot.twist[1].store(twist.linear.y, std::memory_order_relaxed);
+  slot.twist[2].store(twist.linear.z, std::memory_order_relaxed);
+  slot.twist[3].store(twist.angular.x, std::memory_order_relaxed);
+  slot.twist[4].store(twist.angular.y, std::memory_order_relaxed);
+  slot.twist[5].store(twist.angular.z, std::memory_order_relaxed);
+  slot.version.store(version + 2, std::memory_order_release);
+  history_count_.store(index + 1, std::memory_order_release);
+
+  if (msg->header.frame_id != odom_frame_)
+  {
+    boost::mutex::scoped_lock frame_lock(frame_mutex_);
+    odom_frame_ = msg->header.frame_id;
+  }
+
+  if (retain_message_)
+  {
+    boost::mutex::scoped_lock msg_lock(msg_mutex_);
+    odom_msg_ = msg;
+  }
+}
+
+bool OdometryHelper::readSample(uint64_t index, OdometryState& state) const
+{
+  const HistorySlot& slot = history_[index % HISTORY_SIZE];
+  uint32_t version;
+  uint64_t slot_index;
+  int64_t stamp;
+  do
+  {
+    version = slot.version.load(std::memory_order_acquire);
+    slot_index = slot.index.load(std::memory_order_relaxed);
+    state.seq = slot.seq.load(std::memory_order_relaxed);
+    stamp = slot.stamp.load(std::memory_order_relaxed);
+    state.twist.linear.x = slot.twist[0].load(std::memory_order_relaxed);
+    state.twist.linear.y = slot.twist[1].load(std::memory_order_relaxed);
+    state.twist.linear.z = slot.twist[2].load(std::memory_order_relaxed);
+    state.twist.angular.x = slot.twist[3].load(std::memory_order_relaxed);
+    state.twist.angular.y = slot.twist[4].load(std::memory_order_relaxed);
+    state.twist.angular.z = slot.twist[5].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+  }
+  while ((version & 1) || version != slot.version.load(std::memory_order_relaxed));
+  state.stamp.fromNSec(stamp);
+  return slot_index == index;
+}
+
+void OdometryHelper::getOdomState(OdometryState& state) const
+{
+  while (true)
+  {
+    const uint64_t count = history_count_.load(std::memory_order_acquire);
+    if (count == 0)
+    {
+      state = OdometryState();
+      return;
+    }
+    if (readSample(count - 1, state))
+    {
+      return;
+    }
+    // overwritten while reading it, so there's a newer sample; try again
+  }
+}
+
+bool OdometryHelper::getOdomStateAt(const ros::Time& stamp, OdometryState& state) const
+{
+  const uint64_t count = history_count_.load(std::memory_order_acquire);
+  OdometryState newer, older;
+  if (count == 0 || !readSample(count - 1, newer))
+  {
+    return count != 0 && getOdomStateAt(stamp, state);  // if overwritten, there's a newer sample; try again
+  }
+  if (stamp >= newer.stamp)
+  {
+    state = newer;
+    return true;
+  }
+
+  // walk back from the latest sample, as we normally look up recent times
+  const uint64_t first = count > HISTORY_SIZE ? count - HISTORY_SIZE : 0;
+  for (uint64_t index = count - 1; index-- > first;)
+  {
+    if (!readSample(index, older))
+    {
+      return false;  // overwritten while searching, so it's older than the history
+    }
+    if (older.stamp <= stamp)
+    {
+      const double span = (newer.stamp - older.stamp).toSec();
+      const double ratio = span > 0.0 ? (stamp - older.stamp).toSec() / span : 1.0;
+      const geometry_msgs::Twist& t0 = older.twist;
+      const geometry_msgs::Twist& t1 = newer.twist;
+      state.seq = ratio < 0.5 ? older.seq : newer.seq;
+      state.stamp = stamp;
+      state.twist.linear.x = t0.linear.x + ratio * (t1.linear.x - t0.linear.x);
+      state.twist.linear.y = t0.linear.y + ratio * (t1.linear.y - t0.linear.y);
+      state.twist.linear.z = t0.linear.z + ratio * (t1.linear.z - t0.linear.z);
+      state.twist.angular.x = t0.angular.x + ratio * (t1.angular.x - t0.angular.x);
+      state.twist.angular.y = t0.angular.y + ratio * (t1.angular.y - t0.angular.y);
+      state.twist.angular.z = t0.angular.z + ratio * (t1.angular.z - t0.angular.z);
+      return true;
+    }
+    newer = older;
+  }
+  return false;
+}
+
+void OdometryHelper::getVelocityStats(const ros::Duration& window, VelocityStats& stats) const
+{
+  stats = VelocityStats();
+  const uint64_t count = history_count_.load(std::memory_order_acquire);
+  const uint64_t first = count > HISTORY_SIZE ? count - HISTORY_SIZE : 0;
+  ros::Time window_start;
+  OdometryState sample;
+  for (uint64_t index = count; index-- > first;)
+  {
+    if (!readSample(index, sample))
+    {
+      if (index == count - 1)
+      {
+        return getVelocityStats(window, stats);  // there's a newer sample; start over
+      }
+      break;  // overwritten while reading; older samples are gone
+    }
+    if (index == count - 1)
+    {
+      window_start = sample.stamp - window;
+    }
+    else if (sample.stamp < window_start)
+    {
+      break;
+    }
+
+    const double linear = std::hypot(sample.twist.linear.x, sample.twist.linear.y);
+    const double angular = std::abs(sample.twist.angular.z);
+    stats.mean_linear += linear;
+    stats.mean_angular += angular;
+    stats.max_linear = std::max(stats.max_linear, linear);
+    stats.max_angular = std::max(stats.max_angular, angular);
+    ++stats.samples;
+  }
+
+  if (stats.samples)
+  {
+    stats.mean_linear /= stats.samples;
+    stats.mean_angular /= stats.samples;
+  }
+}
+
+std::string OdometryHelper::getOdomFrame() const
+{
+  boost::mutex::scoped_lock lock(frame_mutex_);
+  return odom_frame_;
+}
+
+void OdometryHelper::setRetainMessage(bool retain)
+{
+  boost::mutex::scoped_lock lock(write_mutex_);
+  retain_message_ = retain;
+  if (!retain)
+  {
+    boost::mutex::scoped_lock msg_lock(msg_mutex_);
+    odom_msg_.reset();
+  }
+}
+
+nav_msgs::Odometry::ConstPtr OdometryHelper::getOdomMessage() const
+{
+  boost::mutex::scoped_lock lock(msg_mutex_);
+  return odom_msg_;
 }
 
 void OdometryHelper::getOdom(nav_msgs::Odometry& base_odom) const
 {
-  boost::mutex::scoped_lock lock(odom_mutex_);
-  base_odom = base_odom_;
+  const nav_msgs::Odometry::ConstPtr msg = getOdomMessage();
+  if (msg)
+  {
+    base_odom = *msg;
+  }
+  else
+  {
+    base_odom.header.frame_id = getOdomFrame();
+  }
+
+  OdometryState state;
+  getOdomState(state);
+  base_odom.header.seq = state.seq;
+  base_odom.header.stamp = state.stamp;
+  base_odom.twist.twist = state.twist;
 }
 
 void OdometryHelper::setOdomTopic(const std::string& odom_topic)
@@ -0,0 +1,137 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  oscillation_detector.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include "mbf_utility/oscillation_detector.h"
+#include "mbf_utility/pose_math.h"
+
+namespace mbf_utility
+{
+
+OscillationDetector::OscillationDetector(const ros::Duration &timeout, double distance, double angle,
+                                         double min_path_efficiency)
+  : timeout_(timeout), distance_(distance), angle_(angle), min_path_efficiency_(min_path_efficiency),
+    path_length_(0.0), progressing_(true), oscillating_(false)
+{
+}
+
+void OscillationDetector::setParams(const ros::Duration &timeout, double distance, double angle,
+                                    double min_path_efficiency)
+{
+  timeout_ = timeout;
+  distance_ = distance;
+  angle_ = angle;
+  min_path_efficiency_ = min_path_efficiency;
+  reset();
+}
+
+bool OscillationDetector::isEnabled() const
+{
+  return !timeout_.isZero();
+}
+
+void OscillationDetector::reset()
+{
+  window_.clear();
+  path_length_ = 0.0;
+  progressing_ = true;
+  oscillating_ = false;
+}
+
+bool OscillationDetector::update(const geometry_msgs::PoseStamped &pose, const ros::Time &stamp)
+{
+  if (!isEnabled())
+  {
+    return false;
+  }
+
+  if (!window_.empty() && stamp <= window_.back().stamp)
+  {
+    return oscillating_;
+  }
+
+  Sample sample;
+  sample.pose = pose;
+  sample.stamp = stamp;
+  sample.segment_length = window_.empty() ? 0.0 : distance(window_.back().pose, pose);
+  path_length_ += sample.segment_length;
+  window_.push_back(sample);
+
+  // drop the samples no longer needed to cover the timeout; the path from the dropped sample to the new oldest one
+  // is not part of the window anymore
+  const ros::Time window_start = stamp - timeout_;
+  while (window_.size() > 1 && window_[1].stamp <= window_start)
+  {
+    window_.pop_front();
+    path_length_ -= window_.front().segment_length;
+  }
+  if (window_.size() == 1)
+  {
+    path_length_ = 0.0;  // discard the accumulated rounding errors
+  }
+
+  const Sample &oldest = window_.front();
+  const double net_distance = distance(oldest.pose, pose);
+  progressing_ = angle(oldest.pose, pose) >= angle_ ||
+                 (net_distance >= distance_ && net_distance >= min_path_efficiency_ * path_length_);
+  oscillating_ = !progressing_ && oldest.stamp <= window_start;
+  return oscillating_;
+}
+
+bool OscillationDetector::isProgressing() const
+{
+  return progressing_;
+}
+
+ros::Duration OscillationDetector::getWindowDuration() const
+{
+  return window_.empty() ? ros::Duration(0) : window_.back().stamp - window_.front().stamp;
+}
+
+double OscillationDetector::getNetDistance() const
+{
+  return window_.empty() ? 0.0 : distance(window_.front().pose, window_.back().pose);
+}
+
+double OscillationDetector::getPathLength() const
+{
+  return path_length_;
+}
+
+} /* namespace mbf_utility */
@@ -0,0 +1,161 @@
+/*
+ *  Copyright 2018, Magazino GmbH, Sebastian Pütz, Jorge Santos Simón
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  path_progress_tracker.cpp
+ *
+ *  authors:
+ *    Sebastian Pütz <spuetz@uni-osnabrueck.de>
+ *    Jorge Santos Simón <santos@magazino.eu>
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "mbf_utility/path_progress_tracker.h"
+#include "mbf_utility/pose_math.h"
+
+namespace mbf_utility
+{
+
+PathProgressTracker::PathProgressTracker(double lookahead)
+  : lookahead_(lookahead), initialized_(false), segment_(0), fraction_(0.0), distance_(0.0)
+{
+}
+
+void PathProgressTracker::setPath(const std::vector<geometry_msgs::PoseStamped> &path)
+{
+  points_.resize(path.size());
+  arc_length_.resize(path.size());
+  for (size_t i = 0; i < path.size(); ++i)
+  {
+    points_[i] = path[i].pose.position;
+    arc_length_[i] = i == 0 ? 0.0 : arc_length_[i - 1] + std::sqrt(squaredDistance(points_[i - 1], points_[i]));
+  }
+  initialized_ = false;
+  segment_ = 0;
+  fraction_ = 0.0;
+  distance_ = 0.0;
+}
+
+void PathProgressTracker::clear()
+{
+  setPath(std::vector<geometry_msgs::PoseStamped>());
+}
+
+double PathProgressTracker::project(size_t segment, const geometry_msgs::Point &point, double &fraction) const
+{
+  const geometry_msgs::Point &a = points_[segment];
+  const geometry_msgs::Point &b = points_[segment + 1];
+  const double dx = b.x - a.x;
+  const double dy = b.y - a.y;
+  const double dz = b.z - a.z;
+  const double length2 = dx * dx + dy * dy + dz * dz;
+  fraction = 0.0;
+  if (length2 > 0.0)
+  {
+    fraction = ((point.x - a.x) * dx + (point.y - a.y) * dy + (point.z - a.z) * dz) / length2;
+    fraction = std::min(std::max(fraction, 0.0), 1.0);
+  }
+  geometry_msgs::Point projection;
+  projection.x = a.x + fraction * dx;
+  projection.y = a.y + fraction * dy;
+  projection.z = a.z + fraction * dz;
+  return squaredDistance(point, projection);
+}
+
+bool PathProgressTracker::update(const geometry_msgs::PoseStamped &pose)
+{
+  if (points_.empty())
+  {
+    return false;
+  }
+
+  const geometry_msgs::Point &point = pose.pose.position;
+  if (points_.size() == 1)
+  {
+    distance_ = std::sqrt(squaredDistance(point, points_.front()));
+    initialized_ = true;
+    return true;
+  }
+
+  // on the first update we search the whole path; afterwards, only forward within the lookahead distance
+  const size_t first = initialized_ ? segment_ : 0;
+  const double limit = initialized_ ? getTraveledLength() + lookahead_ : std::numeric_limits<double>::infinity();
+  double min_distance2 = std::numeric_limits<double>::infinity();
+  for (size_t i = first; i < points_.size() - 1 && arc_length_[i] <= limit; ++i)
+  {
+    double fraction;
+    const double distance2 = project(i, point, fraction);
+    if (distance2 < min_distance2)
+    {
+      min_distance2 = distance2;
+      segment_ = i;
+      fraction_ = fraction;
+    }
+  }
+  distance_ = std::sqrt(min_distance2);
+  initialized_ = true;
+  return true;
+}
+
+size_t PathProgressTracker::getSegmentIndex() const
+{
+  return segment_;
+}
+
+double PathProgressTracker::getRemainingLength() const
+{
+  return getPathLength() - getTraveledLength();
+}
+
+double PathProgressTracker::getTraveledLength() const
+{
+  if (points_.size() < 2)
+  {
+    return 0.0;
+  }
+  return arc_length_[segment_] + fraction_ * (arc_length_[segment_ + 1] - arc_length_[segment_]);
+}
+
+double PathProgressTracker::getPathLength() const
+{
+  return arc_length_.empty() ? 0.0 : arc_length_.back();
+}
+
+double PathProgressTracker::getDistanceToPath() const
+{
+  return distance_;
+}
+
+} /* namespace mbf_utility */
@@ -75,27 +75,64 @@ bool RobotInformation::getRobotVelocity(geometry_msgs::TwistStamped &robot_veloc
     return true;
   }
 
-  nav_msgs::Odometry base_odom;
-  odom_helper_.getOdom(base_odom);
-  if (base_odom.header.stamp.isZero())
+  OdometryState odom;
+  odom_helper_.getOdomState(odom);
+  if (odom.stamp.isZero())
   {
     ROS_WARN_STREAM_THROTTLE(2, "No messages received on topic " << odom_helper_.getOdomTopic()
                                                                  << "; robot velocity unknown");
     ROS_WARN_STREAM_THROTTLE(2, "You can disable these warnings by setting parameter 'odom_topic' as empty");
     return false;
   }
-  robot_velocity.header = base_odom.header;
-  robot_velocity.twist = base_odom.twist.twist;
+  robot_velocity.header.seq = odom.seq;
+  robot_velocity.header.stamp = odom.stamp;
+  robot_velocity.header.frame_id = odom_helper_.getOdomFrame();
+  robot_velocity.twist = odom.twist;
   return true;
 }
 
-bool RobotInformation::isRobotStopped(double rot_stopped_velocity, double trans_stopped_velocity) const
+bool RobotInformation::getRobotVelocity(const ros::Time &stamp, geometry_msgs::TwistStamped &robot_velocity) const
 {
-  nav_msgs::Odometry base_odom;
-  odom_helper_.getOdom(base_odom);
-  return fabs(base_odom.twist.twist.angular.z) <= rot_stopped_velocity &&
-         fabs(base_odom.twist.twist.linear.x) <= trans_stopped_velocity &&
-         fabs(base_odom.twist.twist.linear.y) <= trans_stopped_velocity;
+  if (odom_helper_.getOdomTopic().empty())
+  {
+    ROS_DEBUG_THROTTLE(2, "Odometry topic set as empty; ignoring retrieve velocity requests");
+    return true;
+  }
+
+  OdometryState odom;
+  if (!odom_helper_.getOdomStateAt(stamp, odom))
+  {
+    ROS_DEBUG_STREAM_THROTTLE(2, "No odometry received on topic " << odom_helper_.getOdomTopic()
+                                 << " at time " << stamp << "; robot velocity unknown");
+    return false;
+  }
+  robot_velocity.header.seq = odom.seq;
+  robot_velocity.header.stamp = odom.stamp;
+  robot_velocity.header.frame_id = odom_helper_.getOdomFrame();
+  robot_velocity.twist = odom.twist;
+  return true;
+}
+
+bool RobotInformation::getRobotVelocityStats(const ros::Duration &window, VelocityStats &stats) const
+{
+  odom_helper_.getVelocityStats(window, stats);
+  return stats.samples > 0;
+}
+
+bool RobotInformation::isRobotStopped(double rot_stopped_velocity, double trans_stopped_velocity,
+                                      const ros::Duration &window) const
+{
+  VelocityStats stats;
+  if (!window.isZero() && getRobotVelocityStats(window, stats))
+  {
+    return stats.max_angular <= rot_stopped_velocity && stats.max_linear <= trans_stopped_velocity;
+  }
+
+  OdometryState odom;
+  odom_helper_.getOdomState(odom);
+  return fabs(odom.twist.angular.z) <= rot_stopped_velocity &&
+         fabs(odom.twist.linear.x) <= trans_stopped_velocity &&
+         fabs(odom.twist.linear.y) <= trans_stopped_velocity;
 }
 
 const std::string& RobotInformation::getGlobalFrame() const {return global_frame_;};
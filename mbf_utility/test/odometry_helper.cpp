@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <mbf_utility/odometry_helper.h>
+
+#include <boost/make_shared.hpp>
+
+using mbf_utility::OdometryHelper;
+using mbf_utility::OdometryState;
+using mbf_utility::VelocityStats;
+
+// feeds the helper with odometry at 100 Hz, accelerating 1 m/s per second
+void feedOdometry(OdometryHelper& helper, int samples)
+{
+  for (int i = 1; i <= samples; ++i)
+  {
+    boost::shared_ptr<nav_msgs::Odometry> msg = boost::make_shared<nav_msgs::Odometry>();
+    msg->header.seq = i;
+    msg->header.stamp = ros::Time(i * 0.01);
+    msg->header.frame_id = "odom";
+    msg->twist.twist.linear.x = i * 0.01;
+    msg->twist.twist.angular.z = -0.5;
+    helper.odomCallback(msg);
+  }
+}
+
+TEST(OdometryHelper, noOdometry)
+{
+  OdometryHelper helper;
+  OdometryState state;
+  helper.getOdomState(state);
+  EXPECT_TRUE(state.stamp.isZero());
+  EXPECT_FALSE(helper.getOdomStateAt(ros::Time(1.0), state));
+
+  VelocityStats stats;
+  helper.getVelocityStats(ros::Duration(1.0), stats);
+  EXPECT_EQ(stats.samples, 0u);
+}
+
+TEST(OdometryHelper, latestState)
+{
+  OdometryHelper helper;
+  feedOdometry(helper, 10);
+
+  OdometryState state;
+  helper.getOdomState(state);
+  EXPECT_EQ(state.seq, 10u);
+  EXPECT_DOUBLE_EQ(state.stamp.toSec(), 0.1);
+  EXPECT_DOUBLE_EQ(state.twist.linear.x, 0.1);
+  EXPECT_DOUBLE_EQ(state.twist.angular.z, -0.5);
+  EXPECT_EQ(helper.getOdomFrame(), "odom");
+
+  // the full message is only kept if requested
+  EXPECT_FALSE(helper.getOdomMessage());
+  helper.setRetainMessage(true);
+  feedOdometry(helper, 1);
+  ASSERT_TRUE(helper.getOdomMessage());
+  EXPECT_EQ(helper.getOdomMessage()->header.seq, 1u);
+}
+
+TEST(OdometryHelper, interpolatedLookup)
+{
+  OdometryHelper helper;
+  feedOdometry(helper, OdometryHelper::HISTORY_SIZE + 44);
+
+  // between two samples, we get the interpolated velocity
+  OdometryState state;
+  ASSERT_TRUE(helper.getOdomStateAt(ros::Time(2.005), state));
+  EXPECT_NEAR(state.twist.linear.x, 2.005, 1e-6);
+  EXPECT_NEAR(state.twist.angular.z, -0.5, 1e-6);
+  EXPECT_DOUBLE_EQ(state.stamp.toSec(), 2.005);
+
+  // newer than the latest sample, we get the latest one
+  ASSERT_TRUE(helper.getOdomStateAt(ros::Time(10.0), state));
+  EXPECT_EQ(state.seq, OdometryHelper::HISTORY_SIZE + 44);
+
+  // older than the history, we get nothing
+  EXPECT_FALSE(helper.getOdomStateAt(ros::Time(0.2), state));
+}
+
+TEST(OdometryHelper, windowedStats)
+{
+  OdometryHelper helper;
+  feedOdometry(helper, 100);
+
+  // samples from 0.9 to 1.0 s, both included
+  VelocityStats stats;
+  helper.getVelocityStats(ros::Duration(0.1), stats);
+  EXPECT_EQ(stats.samples, 11u);
+  EXPECT_NEAR(stats.mean_linear, 0.95, 1e-6);
+  EXPECT_NEAR(stats.max_linear, 1.0, 1e-6);
+  EXPECT_NEAR(stats.mean_angular, 0.5, 1e-6);
+  EXPECT_NEAR(stats.max_angular, 0.5, 1e-6);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,127 @@
+#include <cmath>
+
+#include <gtest/gtest.h>
+#include <mbf_utility/oscillation_detector.h>
+
+#include <tf/transform_datatypes.h>
+
+using mbf_utility::OscillationDetector;
+
+geometry_msgs::PoseStamped makePose(double x, double y, double yaw)
+{
+  geometry_msgs::PoseStamped pose;
+  pose.header.frame_id = "map";
+  pose.pose.position.x = x;
+  pose.pose.position.y = y;
+  pose.pose.orientation = tf::createQuaternionMsgFromYaw(yaw);
+  return pose;
+}
+
+// 10 Hz updates; 5 s timeout, 0.5 m and 0.5 rad thresholds, and translations must be at least 25 % efficient
+class OscillationDetectorTest : public testing::Test
+{
+ protected:
+  OscillationDetectorTest() : detector_(ros::Duration(5.0), 0.5, 0.5, 0.25), time_(100.0) {}
+
+  bool update(double x, double y = 0.0, double yaw = 0.0)
+  {
+    time_ += ros::Duration(0.1);
+    return detector_.update(makePose(x, y, yaw), time_);
+  }
+
+  OscillationDetector detector_;
+  ros::Time time_;
+};
+
+TEST_F(OscillationDetectorTest, disabled)
+{
+  detector_.setParams(ros::Duration(0), 0.5, 0.5);
+  EXPECT_FALSE(detector_.isEnabled());
+  for (int i = 0; i < 100; ++i)
+  {
+    EXPECT_FALSE(update(0.0));
+  }
+}
+
+TEST_F(OscillationDetectorTest, standingStill)
+{
+  // not oscillating until we have been still for a whole timeout
+  for (int i = 0; i < 50; ++i)
+  {
+    EXPECT_FALSE(update(0.0));
+    EXPECT_FALSE(detector_.isProgressing());
+  }
+  EXPECT_TRUE(update(0.0));
+  EXPECT_NEAR(detector_.getWindowDuration().toSec(), 5.0, 0.11);
+
+  // a reset gives the robot another whole timeout
+  detector_.reset();
+  EXPECT_FALSE(update(0.0));
+}
+
+TEST_F(OscillationDetectorTest, movingForward)
+{
+  // 0.2 m/s, so 1 m per timeout
+  for (int i = 0; i < 200; ++i)
+  {
+    EXPECT_FALSE(update(i * 0.02));
+  }
+  EXPECT_TRUE(detector_.isProgressing());
+  EXPECT_NEAR(detector_.getNetDistance(), 1.0, 0.03);
+  EXPECT_NEAR(detector_.getPathLength(), 1.0, 0.03);
+}
+
+TEST_F(OscillationDetectorTest, rotatingInPlace)
+{
+  // 0.2 rad/s, so 1 rad per timeout
+  for (int i = 0; i < 150; ++i)
+  {
+    EXPECT_FALSE(update(0.0, 0.0, i * 0.02));
+  }
+  EXPECT_TRUE(detector_.isProgressing());
+}
+
+TEST_F(OscillationDetectorTest, backAndForth)
+{
+  // 1.2 m swings at 0.6 m/s; we often are beyond the oscillation distance from where we were one timeout ago,
+  // and we never stay within it from any pose, but we barely make any progress along the path we travel
+  bool oscillating = false;
+  int cycles = 0;
+  for (; cycles < 200 && !oscillating; ++cycles)
+  {
+    const double phase = std::fmod(cycles * 0.06, 2.4);
+    oscillating = update(phase < 1.2 ? phase : 2.4 - phase);
+  }
+  EXPECT_TRUE(oscillating);
+  EXPECT_LT(cycles, 60);
+  EXPECT_GT(detector_.getPathLength(), 4 * detector_.getNetDistance());
+}
+
+TEST_F(OscillationDetectorTest, zigzag)
+{
+  // 0.12 m/s forward while swinging 1 m sideways at 1 m/s; we always are beyond the oscillation distance from where
+  // we were one timeout ago, but we travel a path more than 4 times longer than that
+  bool oscillating = false;
+  int cycles = 0;
+  for (; cycles < 200 && !oscillating; ++cycles)
+  {
+    const double phase = std::fmod(cycles * 0.1, 2.0);
+    oscillating = update(cycles * 0.012, phase < 1.0 ? phase : 2.0 - phase);
+  }
+  EXPECT_TRUE(oscillating);
+  EXPECT_LT(cycles, 60);
+
+  // the path efficiency check is disabled by default, so that's progress
+  detector_.setParams(ros::Duration(5.0), 0.5, 0.5);
+  for (int i = 0; i < 200; ++i)
+  {
+    const double phase = std::fmod(i * 0.1, 2.0);
+    EXPECT_FALSE(update(i * 0.012, phase < 1.0 ? phase : 2.0 - phase));
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <mbf_utility/path_progress_tracker.h>
+
+using mbf_utility::PathProgressTracker;
+
+geometry_msgs::PoseStamped makePose(double x, double y)
+{
+  geometry_msgs::PoseStamped pose;
+  pose.pose.position.x = x;
+  pose.pose.position.y = y;
+  pose.pose.orientation.w = 1.0;
+  return pose;
+}
+
+// straight path along x, from 0 to length, with a pose every 0.1 m
+std::vector<geometry_msgs::PoseStamped> straightPath(double length)
+{
+  std::vector<geometry_msgs::PoseStamped> path;
+  for (int i = 0; i <= static_cast<int>(length * 10 + 0.5); ++i)
+  {
+    path.push_back(makePose(i * 0.1, 0.0));
+  }
+  return path;
+}
+
+TEST(PathProgressTracker, noPath)
+{
+  PathProgressTracker tracker;
+  EXPECT_FALSE(tracker.update(makePose(0.0, 0.0)));
+  EXPECT_DOUBLE_EQ(tracker.getRemainingLength(), 0.0);
+
+  // single pose paths have no length
+  tracker.setPath(std::vector<geometry_msgs::PoseStamped>(1, makePose(1.0, 0.0)));
+  EXPECT_TRUE(tracker.update(makePose(0.0, 0.0)));
+  EXPECT_DOUBLE_EQ(tracker.getRemainingLength(), 0.0);
+  EXPECT_DOUBLE_EQ(tracker.getDistanceToPath(), 1.0);
+}
+
+TEST(PathProgressTracker, straightPath)
+{
+  PathProgressTracker tracker;
+  tracker.setPath(straightPath(10.0));
+  EXPECT_NEAR(tracker.getPathLength(), 10.0, 1e-9);
+
+  // the first update searches the whole path
+  ASSERT_TRUE(tracker.update(makePose(3.05, 0.2)));
+  EXPECT_EQ(tracker.getSegmentIndex(), 30u);
+  EXPECT_NEAR(tracker.getRemainingLength(), 6.95, 1e-9);
+  EXPECT_NEAR(tracker.getTraveledLength(), 3.05, 1e-9);
+  EXPECT_NEAR(tracker.getDistanceToPath(), 0.2, 1e-9);
+
+  // then we follow the robot forward
+  for (double x = 3.05; x < 9.0; x += 0.05)
+  {
+    ASSERT_TRUE(tracker.update(makePose(x, 0.0)));
+    EXPECT_NEAR(tracker.getRemainingLength(), 10.0 - x, 1e-9);
+  }
+
+  // beyond the end of the path
+  tracker.update(makePose(10.5, 0.0));
+  EXPECT_EQ(tracker.getSegmentIndex(), 99u);
+  EXPECT_NEAR(tracker.getRemainingLength(), 0.0, 1e-9);
+  EXPECT_NEAR(tracker.getDistanceToPath(), 0.5, 1e-9);
+}
+
+TEST(PathProgressTracker, lookahead)
+{
+  PathProgressTracker tracker(1.0);
+  tracker.setPath(straightPath(10.0));
+  tracker.update(makePose(0.0, 0.0));
+
+  // a jump longer than the lookahead takes several updates to catch up with; we reach up to the end of the last
+  // segment starting within the lookahead
+  tracker.update(makePose(5.0, 0.0));
+  EXPECT_NEAR(tracker.getTraveledLength(), 1.1, 1e-9);
+  for (int i = 0; i < 5; ++i)
+  {
+    tracker.update(makePose(5.0, 0.0));
+  }
+  EXPECT_NEAR(tracker.getTraveledLength(), 5.0, 1e-9);
+}
+
+TEST(PathProgressTracker, returningPath)
+{
+  // go to x = 5 and back over the same line; the robot on the way out must not jump to the way back
+  std::vector<geometry_msgs::PoseStamped> path = straightPath(5.0);
+  for (int i = 49; i >= 0; --i)
+  {
+    path.push_back(makePose(i * 0.1, 0.0));
+  }
+  PathProgressTracker tracker;
+  tracker.setPath(path);
+  EXPECT_NEAR(tracker.getPathLength(), 10.0, 1e-9);
+
+  for (double x = 0.0; x < 4.5; x += 0.05)
+  {
+    tracker.update(makePose(x, 0.0));
+    EXPECT_NEAR(tracker.getRemainingLength(), 10.0 - x, 1e-9);
+  }
+
+  // once on the way back, we never return to the way out; note that poses on both ways are ambiguous, so we
+  // switch to the way back only once the robot is past the last pose of the way out
+  tracker.update(makePose(5.0, 0.0));
+  for (double x = 4.85; x > 2.0; x -= 0.05)
+  {
+    tracker.update(makePose(x, 0.0));
+    EXPECT_NEAR(tracker.getRemainingLength(), x, 1e-9);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
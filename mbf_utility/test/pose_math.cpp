@@ -0,0 +1,147 @@
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <mbf_utility/pose_math.h>
+
+#include <tf/transform_datatypes.h>
+
+using namespace mbf_utility;
+
+// the implementation mbf_utility::angle used to have; the reference for the fast paths
+double tfAngle(const geometry_msgs::Quaternion &q1, const geometry_msgs::Quaternion &q2)
+{
+  tf::Quaternion rot1, rot2;
+  tf::quaternionMsgToTF(q1, rot1);
+  tf::quaternionMsgToTF(q2, rot2);
+  return rot1.angleShortestPath(rot2);
+}
+
+double randomDouble(double min, double max)
+{
+  return min + (max - min) * std::rand() / RAND_MAX;
+}
+
+geometry_msgs::PoseStamped randomPose(bool planar)
+{
+  geometry_msgs::PoseStamped pose;
+  pose.pose.position.x = randomDouble(-10.0, 10.0);
+  pose.pose.position.y = randomDouble(-10.0, 10.0);
+  pose.pose.position.z = planar ? 0.0 : randomDouble(-1.0, 1.0);
+  tf::Quaternion q;
+  q.setRPY(planar ? 0.0 : randomDouble(-M_PI, M_PI), planar ? 0.0 : randomDouble(-M_PI, M_PI), randomDouble(-M_PI, M_PI));
+  tf::quaternionTFToMsg(q, pose.pose.orientation);
+  return pose;
+}
+
+std::vector<geometry_msgs::PoseStamped> randomPoses(size_t count, bool planar)
+{
+  std::srand(42);
+  std::vector<geometry_msgs::PoseStamped> poses(count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    poses[i] = randomPose(planar);
+  }
+  return poses;
+}
+
+TEST(PoseMath, planarAngle)
+{
+  const std::vector<geometry_msgs::PoseStamped> poses = randomPoses(1000, true);
+  for (size_t i = 1; i < poses.size(); ++i)
+  {
+    const geometry_msgs::Quaternion &q1 = poses[i - 1].pose.orientation;
+    const geometry_msgs::Quaternion &q2 = poses[i].pose.orientation;
+    ASSERT_TRUE(isPlanar(q1));
+    EXPECT_NEAR(angle(q1, q2), tfAngle(q1, q2), 1e-9);
+    EXPECT_NEAR(planarAngle(q1, q2), angle3D(q1, q2), 1e-9);
+  }
+  EXPECT_NEAR(angle(tf::createQuaternionMsgFromYaw(3.0), tf::createQuaternionMsgFromYaw(-3.0)), 2 * M_PI - 6.0, 1e-9);
+}
+
+TEST(PoseMath, angle3D)
+{
+  const std::vector<geometry_msgs::PoseStamped> poses = randomPoses(1000, false);
+  for (size_t i = 1; i < poses.size(); ++i)
+  {
+    const geometry_msgs::Quaternion &q1 = poses[i - 1].pose.orientation;
+    const geometry_msgs::Quaternion &q2 = poses[i].pose.orientation;
+    EXPECT_NEAR(angle(q1, q2), tfAngle(q1, q2), 1e-9);
+
+    // not normalized quaternions are equivalent to the normalized ones
+    geometry_msgs::Quaternion q3 = q2;
+    q3.x *= 2.0; q3.y *= 2.0; q3.z *= 2.0; q3.w *= 2.0;
+    EXPECT_NEAR(angle(q1, q3), tfAngle(q1, q2), 1e-9);
+  }
+}
+
+TEST(PoseMath, zeroQuaternion)
+{
+  // taken as the identity
+  const geometry_msgs::Quaternion zero;
+  EXPECT_DOUBLE_EQ(angle(zero, zero), 0.0);
+  EXPECT_NEAR(angle(zero, tf::createQuaternionMsgFromYaw(0.5)), 0.5, 1e-9);
+  EXPECT_NEAR(angle(tf::createQuaternionMsgFromRollPitchYaw(0.5, 0.0, 0.0), zero), 0.5, 1e-9);
+}
+
+TEST(PoseMath, batched)
+{
+  const std::vector<geometry_msgs::PoseStamped> poses = randomPoses(100, false);
+  const geometry_msgs::PoseStamped reference = poses[42];
+
+  std::vector<double> dists, angs;
+  distances(poses, reference, dists);
+  angles(poses, reference, angs);
+  ASSERT_EQ(dists.size(), poses.size());
+  ASSERT_EQ(angs.size(), poses.size());
+  double length = 0.0;
+  for (size_t i = 0; i < poses.size(); ++i)
+  {
+    EXPECT_DOUBLE_EQ(dists[i], distance(poses[i], reference));
+    EXPECT_DOUBLE_EQ(angs[i], angle(poses[i], reference));
+    length += i > 0 ? distance(poses[i - 1], poses[i]) : 0.0;
+  }
+  EXPECT_EQ(closestPose(poses, reference), 42u);
+  EXPECT_DOUBLE_EQ(pathLength(poses.begin(), poses.end()), length);
+  EXPECT_DOUBLE_EQ(pathLength(poses.begin(), poses.begin() + 1), 0.0);
+  EXPECT_DOUBLE_EQ(pathLength(poses.end(), poses.end()), 0.0);
+}
+
+// Microbenchmark against the tf-based implementation; it only reports the timings, as asserting on them would make
+// the test flaky on loaded machines
+template <typename F>
+double benchmark(const std::vector<geometry_msgs::PoseStamped> &poses, F angle_function)
+{
+  const int repetitions = 1000;
+  volatile double sum = 0.0;
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repetitions; ++r)
+  {
+    for (size_t i = 1; i < poses.size(); ++i)
+    {
+      sum += angle_function(poses[i - 1].pose.orientation, poses[i].pose.orientation);
+    }
+  }
+  const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / (repetitions * (poses.size() - 1));
+}
+
+TEST(PoseMath, benchmark)
+{
+  typedef double (*AngleFunction)(const geometry_msgs::Quaternion&, const geometry_msgs::Quaternion&);
+  for (bool planar : { true, false })
+  {
+    const std::vector<geometry_msgs::PoseStamped> poses = randomPoses(1000, planar);
+    const double tf_ns = benchmark(poses, &tfAngle);
+    const double fast_ns = benchmark(poses, static_cast<AngleFunction>(&angle));
+    RecordProperty(planar ? "planar_speedup" : "3d_speedup", std::to_string(tf_ns / fast_ns));
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}